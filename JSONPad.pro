@@ -24,14 +24,60 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 CONFIG += c++11
 
+# Uncomment to log how long the CBOR and MessagePack transcoders take next to the
+# same conversion through QCborValue and QJsonDocument (requires Qt 5.12).
+#DEFINES += JSONPAD_TRANSCODER_BENCHMARK
+
+# Uncomment to log how long formatting takes with the formatter from before the style
+# options next to the specialized one with the default style, on the same text.
+#DEFINES += JSONPAD_FORMATTER_BENCHMARK
+
 SOURCES += \
         main.cpp \
         mainwindow.cpp \
-        jsoneditor.cpp
+        jsoneditor.cpp \
+        jsonstructureindex.cpp \
+        jsonoutlinemodel.cpp \
+        jsonpositionmap.cpp \
+        jsondiff.cpp \
+        jsondiffdialog.cpp \
+        jsonformatter.cpp \
+        jsonkeysorter.cpp \
+        preferencesdialog.cpp \
+        jsonindexcache.cpp \
+        jsonjournal.cpp \
+        jsoncanonicalizer.cpp \
+        jsontranscoder.cpp \
+        jsonworkerpool.cpp \
+        jsondocumenttab.cpp \
+        jsonquery.cpp \
+        jsonmemoryusage.cpp \
+        memoryusagedialog.cpp \
+        jsonfileloader.cpp \
+        jsonstartuptrace.cpp
 
 HEADERS += \
         mainwindow.h \
-        jsoneditor.h
+        jsoneditor.h \
+        jsonstructureindex.h \
+        jsonoutlinemodel.h \
+        jsonpositionmap.h \
+        jsondiff.h \
+        jsondiffdialog.h \
+        jsonformatter.h \
+        jsonkeysorter.h \
+        preferencesdialog.h \
+        jsonindexcache.h \
+        jsonjournal.h \
+        jsoncanonicalizer.h \
+        jsontranscoder.h \
+        jsonworkerpool.h \
+        jsondocumenttab.h \
+        jsonquery.h \
+        jsonmemoryusage.h \
+        memoryusagedialog.h \
+        jsonfileloader.h \
+        jsonstartuptrace.h
 
 FORMS += \
         mainwindow.ui
@@ -0,0 +1,670 @@
+/**
+ * @file jsoncanonicalizer.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsoncanonicalizer.h"
+#include <QFile>
+#include <QDateTime>
+#include <cstring>
+#include <algorithm>
+#include <climits>
+
+#define CANONICAL_MEMORY_BUDGET		(64 * 1024 * 1024)
+#define OUTPUT_BUFFER_SIZE			(1024 * 1024)
+#define MIN_RUN_MEMBERS				4096
+#define MIN_MERGE_BUFFER_MEMBERS	256
+#define MAX_MERGE_BUFFER_MEMBERS	4096
+
+// Up to this fraction of the memory budget holds the recorded ends of nested containers,
+// counting each one at about what a hash entry for it takes.
+#define CONTAINER_END_SHARE			4
+#define CONTAINER_END_BYTES			32
+
+JsonCanonicalizer::JsonCanonicalizer(const QString &source, const QString &destination, QObject *parent) :
+	QThread(parent),
+	_sourceName(source),
+	_destinationName(destination),
+	_memoryBudget(CANONICAL_MEMORY_BUDGET),
+	_data(NULL),
+	_size(0),
+	_written(0),
+	_progress(0),
+	_spillEnd(0),
+	_bufferedMembers(0),
+	_cancelled(0),
+	_succeeded(false)
+{
+}
+
+JsonCanonicalizer::~JsonCanonicalizer()
+{
+	cancel();
+	wait();
+}
+
+void JsonCanonicalizer::setMemoryBudget(qint64 bytes)
+{
+	_memoryBudget = bytes;
+}
+
+bool JsonCanonicalizer::succeeded() const
+{
+	return _succeeded;
+}
+
+bool JsonCanonicalizer::wasCancelled() const
+{
+	return _cancelled.load() != 0;
+}
+
+QString JsonCanonicalizer::errorString() const
+{
+	return _error;
+}
+
+void JsonCanonicalizer::cancel()
+{
+	_cancelled.store(1);
+}
+
+void JsonCanonicalizer::run()
+{
+	qint64 timeStart = QDateTime::currentMSecsSinceEpoch();
+
+	QFile source(_sourceName);
+	if (!source.open(QFile::ReadOnly))
+	{
+		_error = QString("Could not open %1: %2").arg(_sourceName, source.errorString());
+		return;
+	}
+
+	_size = source.size();
+	uchar *mapped = _size > 0 ? source.map(0, _size) : NULL;
+	if (_size > 0 && mapped == NULL)
+	{
+		_error = QString("Could not map %1: %2").arg(_sourceName, source.errorString());
+		return;
+	}
+	_data = reinterpret_cast<const char *>(mapped);
+
+	_output.setFileName(_destinationName);
+	if (!_output.open(QFile::WriteOnly))
+	{
+		_error = QString("Could not create %1: %2").arg(_destinationName, _output.errorString());
+		source.unmap(mapped);
+		return;
+	}
+	_outputBuffer.reserve(OUTPUT_BUFFER_SIZE);
+
+	// Skip a byte order mark, which has no place in canonical output.
+	qint64 position = (_size >= 3 && std::memcmp(_data, "\xEF\xBB\xBF", 3) == 0) ? 3 : 0;
+	bool succeeded = true;
+	bool firstValue = true;
+
+	while (succeeded)
+	{
+		position = skipWhitespace(position);
+		if (position >= _size)
+		{
+			break;
+		}
+
+		// Top-level values stay one per line, as they are in JSON Lines files.
+		if (!firstValue)
+		{
+			succeeded = write('\n');
+		}
+		firstValue = false;
+
+		succeeded = succeeded && canonicalize(position, position);
+	}
+
+	succeeded = succeeded && flushOutput();
+	source.unmap(mapped);
+	_data = NULL;
+	_spillFile.close();
+	_containerEnds.clear();
+
+	if (!succeeded || !_output.commit())
+	{
+		_output.cancelWriting();
+		if (_error.isEmpty())
+		{
+			_error = QString("Could not write %1: %2").arg(_destinationName, _output.errorString());
+		}
+		return;
+	}
+
+	_succeeded = true;
+	emit progressChanged(100);
+	qDebug("time to canonicalize: %lld ms", QDateTime::currentMSecsSinceEpoch() - timeStart);
+}
+
+bool JsonCanonicalizer::canonicalize(qint64 start, qint64 &end)
+{
+	// Nesting is tracked on an explicit stack, since documents can be nested far deeper than the call stack allows.
+	QVector<Frame> stack;
+	qint64 position = start;
+
+	while (true)
+	{
+		if (_cancelled.load())
+		{
+			return fail(position, "Cancelled");
+		}
+
+		if (position != -1)
+		{
+			if (position >= _size)
+			{
+				return fail(position, "Unexpected end of file");
+			}
+
+			char character = _data[position];
+			if (character == '{' || character == '[')
+			{
+				Frame frame;
+				frame.object = character == '{';
+				frame.first = true;
+				frame.position = position + 1;
+				frame.end = -1;
+				frame.next = 0;
+				frame.spillBase = _spillEnd;
+				frame.buffered = 0;
+
+				if (frame.object && !collectMembers(position, frame))
+				{
+					return false;
+				}
+				_bufferedMembers += frame.buffered;
+				stack.append(frame);
+
+				if (!write(character))
+				{
+					return false;
+				}
+			}
+			else
+			{
+				qint64 valueEnd = character == '"' ? stringEnd(position) : scalarEnd(position);
+				if (valueEnd == -1 || valueEnd == position)
+				{
+					return fail(position, "Expected a value");
+				}
+				if (!write(_data + position, valueEnd - position))
+				{
+					return false;
+				}
+
+				if (stack.isEmpty())
+				{
+					end = valueEnd;
+					return true;
+				}
+				stack.last().position = valueEnd;
+			}
+			position = -1;
+			continue;
+		}
+
+		Frame &frame = stack.last();
+		qint64 finished;
+
+		if (frame.object)
+		{
+			Member member;
+			if (nextMember(frame, member))
+			{
+				if ((!frame.first && !write(',')) || !write('"') || !write(_data + member.key, member.keyLength) || !write("\":", 2))
+				{
+					return false;
+				}
+				frame.first = false;
+				position = member.value;
+				continue;
+			}
+			if (!_error.isEmpty() || !write('}'))
+			{
+				return false;
+			}
+			finished = frame.end;
+		}
+		else
+		{
+			qint64 next = skipWhitespace(frame.position);
+			if (next < _size && _data[next] == ']')
+			{
+				if (!write(']'))
+				{
+					return false;
+				}
+				finished = next + 1;
+			}
+			else
+			{
+				if (!frame.first)
+				{
+					if (next >= _size || _data[next] != ',')
+					{
+						return fail(next, "Expected ',' or ']'");
+					}
+					next = skipWhitespace(next + 1);
+					if (!write(','))
+					{
+						return false;
+					}
+				}
+				frame.first = false;
+				position = next;
+				continue;
+			}
+		}
+
+		// The container is complete, so its members and spilled runs can be released.
+		_bufferedMembers -= frame.buffered;
+		_spillEnd = frame.spillBase;
+		stack.removeLast();
+
+		if (stack.isEmpty())
+		{
+			end = finished;
+			return true;
+		}
+		stack.last().position = finished;
+	}
+}
+
+bool JsonCanonicalizer::collectMembers(qint64 open, Frame &frame)
+{
+	// Whatever the enclosing objects are holding counts against the budget.
+	const qint64 runLimit = qMax(qint64(MIN_RUN_MEMBERS), budgetMembers() - _bufferedMembers);
+
+	qint64 position = skipWhitespace(open + 1);
+	if (position < _size && _data[position] == '}')
+	{
+		frame.end = position + 1;
+		return true;
+	}
+
+	while (true)
+	{
+		if (_cancelled.load())
+		{
+			return fail(position, "Cancelled");
+		}
+
+		if (position >= _size || _data[position] != '"')
+		{
+			return fail(position, "Expected an object key");
+		}
+		qint64 keyEnd = stringEnd(position);
+		if (keyEnd == -1)
+		{
+			return fail(position, "Unterminated string");
+		}
+
+		qint64 colon = skipWhitespace(keyEnd);
+		if (colon >= _size || _data[colon] != ':')
+		{
+			return fail(colon, "Expected ':'");
+		}
+
+		Member member;
+		member.key = position + 1;
+		member.keyLength = keyEnd - position - 2;
+		member.value = skipWhitespace(colon + 1);
+
+		qint64 end = valueEnd(member.value);
+		if (end == -1)
+		{
+			return fail(member.value, "Expected a value");
+		}
+
+		frame.members.append(member);
+		if (frame.members.size() >= runLimit && !spill(frame))
+		{
+			return false;
+		}
+
+		position = skipWhitespace(end);
+		if (position < _size && _data[position] == ',')
+		{
+			position = skipWhitespace(position + 1);
+		}
+		else if (position < _size && _data[position] == '}')
+		{
+			frame.end = position + 1;
+			break;
+		}
+		else
+		{
+			return fail(position, "Expected ',' or '}'");
+		}
+	}
+
+	if (frame.runs.isEmpty())
+	{
+		std::stable_sort(frame.members.begin(), frame.members.end(), [this](const Member &left, const Member &right)
+		{
+			return compareKeys(left, right) < 0;
+		});
+		frame.buffered = frame.members.size();
+		return true;
+	}
+
+	return (frame.members.isEmpty() || spill(frame)) && startMerge(frame);
+}
+
+bool JsonCanonicalizer::nextMember(Frame &frame, Member &member)
+{
+	if (frame.runs.isEmpty())
+	{
+		if (frame.next == frame.members.size())
+		{
+			return false;
+		}
+		member = frame.members.at(frame.next++);
+		return true;
+	}
+
+	if (frame.heap.empty())
+	{
+		return false;
+	}
+
+	auto greater = [this, &frame](int left, int right) { return runLess(frame, right, left); };
+	std::pop_heap(frame.heap.begin(), frame.heap.end(), greater);
+	int run = frame.heap.back();
+	frame.heap.pop_back();
+
+	RunReader &reader = frame.runs[run];
+	member = reader.buffer.at(reader.next++);
+
+	if (reader.next < reader.buffer.size() || fill(reader))
+	{
+		frame.heap.push_back(run);
+		std::push_heap(frame.heap.begin(), frame.heap.end(), greater);
+	}
+	return _error.isEmpty();
+}
+
+bool JsonCanonicalizer::spill(Frame &frame)
+{
+	if (!_spillFile.isOpen() && !_spillFile.open())
+	{
+		_error = QString("Could not create a temporary file: %1").arg(_spillFile.errorString());
+		return false;
+	}
+
+	std::stable_sort(frame.members.begin(), frame.members.end(), [this](const Member &left, const Member &right)
+	{
+		return compareKeys(left, right) < 0;
+	});
+
+	qint64 bytes = qint64(frame.members.size()) * sizeof(Member);
+	if (!_spillFile.seek(_spillEnd) || _spillFile.write(reinterpret_cast<const char *>(frame.members.constData()), bytes) != bytes)
+	{
+		_error = QString("Could not write to a temporary file: %1").arg(_spillFile.errorString());
+		return false;
+	}
+
+	RunReader run;
+	run.offset = _spillEnd;
+	run.remaining = frame.members.size();
+	run.capacity = 0;
+	run.next = 0;
+	frame.runs.append(run);
+
+	_spillEnd += bytes;
+	frame.members.clear();
+	return true;
+}
+
+bool JsonCanonicalizer::startMerge(Frame &frame)
+{
+	// Runs are merged in the order they were spilled, so members with equal keys keep their order.
+	const qint64 share = (budgetMembers() - _bufferedMembers) / frame.runs.size();
+	const int capacity = int(qBound(qint64(MIN_MERGE_BUFFER_MEMBERS), share, qint64(MAX_MERGE_BUFFER_MEMBERS)));
+
+	frame.members.squeeze();
+	for (int run = 0; run < frame.runs.size(); run++)
+	{
+		frame.runs[run].capacity = capacity;
+		if (!fill(frame.runs[run]))
+		{
+			return false;
+		}
+		frame.heap.push_back(run);
+	}
+
+	std::make_heap(frame.heap.begin(), frame.heap.end(), [this, &frame](int left, int right) { return runLess(frame, right, left); });
+	frame.buffered = qint64(capacity) * frame.runs.size();
+	return true;
+}
+
+bool JsonCanonicalizer::fill(RunReader &reader)
+{
+	if (reader.remaining == 0)
+	{
+		return false;
+	}
+
+	int count = int(qMin(reader.remaining, qint64(reader.capacity)));
+	qint64 bytes = qint64(count) * sizeof(Member);
+	reader.buffer.resize(count);
+
+	if (!_spillFile.seek(reader.offset) || _spillFile.read(reinterpret_cast<char *>(reader.buffer.data()), bytes) != bytes)
+	{
+		_error = QString("Could not read from a temporary file: %1").arg(_spillFile.errorString());
+		return false;
+	}
+
+	reader.offset += bytes;
+	reader.remaining -= count;
+	reader.next = 0;
+	return true;
+}
+
+bool JsonCanonicalizer::runLess(const Frame &frame, int left, int right) const
+{
+	const RunReader &leftReader = frame.runs.at(left);
+	const RunReader &rightReader = frame.runs.at(right);
+	int comparison = compareKeys(leftReader.buffer.at(leftReader.next), rightReader.buffer.at(rightReader.next));
+	return comparison < 0 || (comparison == 0 && left < right);
+}
+
+int JsonCanonicalizer::compareKeys(const Member &left, const Member &right) const
+{
+	int comparison = std::memcmp(_data + left.key, _data + right.key, size_t(qMin(left.keyLength, right.keyLength)));
+	if (comparison != 0)
+	{
+		return comparison;
+	}
+	return left.keyLength < right.keyLength ? -1 : (left.keyLength > right.keyLength ? 1 : 0);
+}
+
+qint64 JsonCanonicalizer::skipWhitespace(qint64 position) const
+{
+	while (position < _size && (_data[position] == ' ' || _data[position] == '\n' || _data[position] == '\r' || _data[position] == '\t'))
+	{
+		position++;
+	}
+	return position;
+}
+
+qint64 JsonCanonicalizer::stringEnd(qint64 position) const
+{
+	// Find each quote directly and count the backslashes before it to tell whether it is escaped.
+	qint64 search = position + 1;
+	while (search < _size)
+	{
+		const char *quote = static_cast<const char *>(std::memchr(_data + search, '"', size_t(_size - search)));
+		if (quote == NULL)
+		{
+			return -1;
+		}
+
+		qint64 end = quote - _data;
+		qint64 backslashes = 0;
+		while (end - backslashes - 1 > position && _data[end - backslashes - 1] == '\\')
+		{
+			backslashes++;
+		}
+		if (backslashes % 2 == 0)
+		{
+			return end + 1;
+		}
+		search = end + 1;
+	}
+	return -1;
+}
+
+qint64 JsonCanonicalizer::scalarEnd(qint64 position) const
+{
+	if (position >= _size || !(_data[position] == '-' || (_data[position] >= '0' && _data[position] <= '9') ||
+							   _data[position] == 't' || _data[position] == 'f' || _data[position] == 'n'))
+	{
+		return -1;
+	}
+
+	while (position < _size)
+	{
+		char character = _data[position];
+		if (character == ',' || character == ']' || character == '}' || character == ' ' || character == '\n' || character == '\r' || character == '\t')
+		{
+			break;
+		}
+		position++;
+	}
+	return position;
+}
+
+qint64 JsonCanonicalizer::valueEnd(qint64 position)
+{
+	if (position >= _size)
+	{
+		return -1;
+	}
+
+	if (_data[position] == '"')
+	{
+		return stringEnd(position);
+	}
+
+	if (_data[position] != '{' && _data[position] != '[')
+	{
+		return scalarEnd(position);
+	}
+
+	// Containers inside an object were seen when the members of an enclosing object were collected.
+	QHash<qint64, qint64>::iterator recorded = _containerEnds.find(position);
+	if (recorded != _containerEnds.end())
+	{
+		qint64 end = recorded.value();
+		_containerEnds.erase(recorded);
+		return end;
+	}
+
+	// The end of every container held by an object in here is recorded on the way, so that
+	// collecting the members of those objects later doesn't scan the same text again.
+	const int recordLimit = int(qMin(qint64(INT_MAX), _memoryBudget / (CONTAINER_END_SHARE * CONTAINER_END_BYTES)));
+	std::vector<qint64> open;
+	for (qint64 i = position; i < _size; i++)
+	{
+		switch (_data[i])
+		{
+			case '"':
+				i = stringEnd(i);
+				if (i == -1)
+				{
+					return -1;
+				}
+				i--;
+				break;
+			case '{':
+			case '[':
+				open.push_back(i);
+				break;
+			case '}':
+			case ']':
+			{
+				qint64 start = open.back();
+				open.pop_back();
+				if (open.empty())
+				{
+					return i + 1;
+				}
+				if (_data[open.back()] == '{' && _containerEnds.size() < recordLimit)
+				{
+					_containerEnds.insert(start, i + 1);
+				}
+				break;
+			}
+		}
+	}
+	return -1;
+}
+
+qint64 JsonCanonicalizer::budgetMembers() const
+{
+	// Whatever isn't set aside for container ends is for members.
+	return (_memoryBudget - _memoryBudget / CONTAINER_END_SHARE) / qint64(sizeof(Member));
+}
+
+bool JsonCanonicalizer::write(const char *data, qint64 length)
+{
+	if (_outputBuffer.size() + length > OUTPUT_BUFFER_SIZE && !flushOutput())
+	{
+		return false;
+	}
+
+	// Long strings go straight from the mapping to the file.
+	if (length >= OUTPUT_BUFFER_SIZE)
+	{
+		if (_output.write(data, length) != length)
+		{
+			return false;
+		}
+		_written += length;
+		return true;
+	}
+
+	_outputBuffer.append(data, int(length));
+	return true;
+}
+
+bool JsonCanonicalizer::write(char character)
+{
+	return write(&character, 1);
+}
+
+bool JsonCanonicalizer::flushOutput()
+{
+	if (_output.write(_outputBuffer) != _outputBuffer.size())
+	{
+		return false;
+	}
+	_written += _outputBuffer.size();
+	_outputBuffer.resize(0);
+
+	// Whitespace is dropped, so the output grows a little slower than the source is read.
+	int progress = _size > 0 ? int(qMin(qint64(99), _written * 100 / _size)) : 0;
+	if (progress != _progress)
+	{
+		_progress = progress;
+		emit progressChanged(progress);
+	}
+	return true;
+}
+
+bool JsonCanonicalizer::fail(qint64 position, const QString &message)
+{
+	if (_error.isEmpty())
+	{
+		_error = QString("%1 at byte %2.").arg(message).arg(position);
+	}
+	return false;
+}
@@ -0,0 +1,130 @@
+/**
+ * @file jsoncanonicalizer.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Streaming transformer that writes a JSON file with sorted keys and no whitespace.
+ */
+#ifndef JSONCANONICALIZER_H
+#define JSONCANONICALIZER_H
+
+#include <QThread>
+#include <QVector>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QHash>
+#include <QSaveFile>
+#include <QTemporaryFile>
+#include <vector>
+
+/**
+ * The source file is memory-mapped and never decoded.  The members of each object are
+ * gathered as offsets into the mapping and sorted by the raw bytes of their keys, then
+ * written in that order; strings and numbers are copied through unchanged.  When the
+ * members of the open objects would exceed the memory budget, sorted runs of members
+ * are spilled to a temporary file and merged back while writing, so the only memory
+ * needed is the budget and the output buffer.
+ *
+ * Finding where a member's value ends means reading through it.  The ends of the
+ * containers held by objects inside it are recorded as it is read, within a share of the
+ * budget, so each byte is read about once however deeply the document is nested.
+ */
+class JsonCanonicalizer : public QThread
+{
+	Q_OBJECT
+
+public:
+	JsonCanonicalizer(const QString &source, const QString &destination, QObject *parent = nullptr);
+	virtual ~JsonCanonicalizer();
+
+	void setMemoryBudget(qint64 bytes);
+
+	bool succeeded() const;
+	bool wasCancelled() const;
+	QString errorString() const;
+
+public slots:
+	void cancel();
+
+signals:
+	void progressChanged(int percent);
+
+protected:
+	virtual void run();
+
+private:
+	struct Member
+	{
+		qint64 key;
+		qint64 keyLength;
+		qint64 value;
+	};
+
+	struct RunReader
+	{
+		qint64 offset;
+		qint64 remaining;
+		int capacity;
+		QVector<Member> buffer;
+		int next;
+	};
+
+	struct Frame
+	{
+		bool object;
+		bool first;
+		qint64 position;
+		qint64 end;
+		QVector<Member> members;
+		int next;
+		QVector<RunReader> runs;
+		std::vector<int> heap;
+		qint64 spillBase;
+		qint64 buffered;
+	};
+
+	bool canonicalize(qint64 start, qint64 &end);
+	bool collectMembers(qint64 open, Frame &frame);
+	bool nextMember(Frame &frame, Member &member);
+
+	bool spill(Frame &frame);
+	bool startMerge(Frame &frame);
+	bool fill(RunReader &reader);
+	bool runLess(const Frame &frame, int left, int right) const;
+
+	int compareKeys(const Member &left, const Member &right) const;
+	qint64 skipWhitespace(qint64 position) const;
+	qint64 stringEnd(qint64 position) const;
+	qint64 scalarEnd(qint64 position) const;
+	qint64 valueEnd(qint64 position);
+	qint64 budgetMembers() const;
+
+	bool write(const char *data, qint64 length);
+	bool write(char character);
+	bool flushOutput();
+	bool fail(qint64 position, const QString &message);
+
+	QString _sourceName;
+	QString _destinationName;
+	qint64 _memoryBudget;
+
+	const char *_data;
+	qint64 _size;
+
+	QSaveFile _output;
+	QByteArray _outputBuffer;
+	qint64 _written;
+	int _progress;
+
+	QTemporaryFile _spillFile;
+	qint64 _spillEnd;
+	qint64 _bufferedMembers;
+
+	QHash<qint64, qint64> _containerEnds;		///< End of each nested container by its start, until it is looked up.
+
+	QAtomicInt _cancelled;
+	bool _succeeded;
+	QString _error;
+};
+
+#endif // JSONCANONICALIZER_H
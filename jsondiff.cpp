@@ -0,0 +1,181 @@
+/**
+ * @file jsondiff.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsondiff.h"
+#include <QHash>
+#include <QDateTime>
+
+JsonDiff::JsonDiff(const JsonStructureIndex &left, const JsonStructureIndex &right) :
+	_left(left),
+	_right(right)
+{
+}
+
+QVector<JsonDiff::Change> JsonDiff::compare(const JsonStructureIndex &left, const JsonStructureIndex &right)
+{
+	qint64 timeStart = QDateTime::currentMSecsSinceEpoch();
+
+	JsonDiff diff(left, right);
+
+	// Top-level values are paired up by position.
+	int roots = qMax(left.rootCount(), right.rootCount());
+	for (int i = 0; i < roots; i++)
+	{
+		JsonStructureIndex::Member leftMember = left.member(-1, i);
+		JsonStructureIndex::Member rightMember = right.member(-1, i);
+		QString path = roots > 1 ? QString("$[%1]").arg(i) : QString("$");
+
+		if (leftMember.index == -1)
+		{
+			diff.addChange(Added, path, NULL, &rightMember);
+		}
+		else if (rightMember.index == -1)
+		{
+			diff.addChange(Removed, path, &leftMember, NULL);
+		}
+		else
+		{
+			diff.compareMembers(leftMember, rightMember, path);
+		}
+	}
+
+	qDebug("time to compare documents: %lld ms", QDateTime::currentMSecsSinceEpoch() - timeStart);
+	return diff._changes;
+}
+
+void JsonDiff::compareMembers(const JsonStructureIndex::Member &left, const JsonStructureIndex::Member &right, const QString &path)
+{
+	if (left.container != -1 && right.container != -1)
+	{
+		const JsonStructureIndex::Container &leftContainer = _left.container(left.container);
+		const JsonStructureIndex::Container &rightContainer = _right.container(right.container);
+
+		if (leftContainer.isArray != rightContainer.isArray)
+		{
+			addChange(Changed, path, &left, &right);
+		}
+		else if (leftContainer.hash == rightContainer.hash)
+		{
+			// Identical subtrees.
+			return;
+		}
+		else if (leftContainer.isArray)
+		{
+			compareArrays(left.container, right.container, path);
+		}
+		else
+		{
+			compareObjects(left.container, right.container, path);
+		}
+	}
+	else if (!identical(left, right))
+	{
+		addChange(Changed, path, &left, &right);
+	}
+}
+
+void JsonDiff::compareObjects(int left, int right, const QString &path)
+{
+	QVector<JsonStructureIndex::Member> rightMembers = _right.members(right);
+
+	QHash<QString, int> rightKeys;
+	rightKeys.reserve(rightMembers.count());
+	for (int i = 0; i < rightMembers.count(); i++)
+	{
+		rightKeys.insert(_right.keyName(rightMembers.at(i)), i);
+	}
+
+	QVector<bool> matched(rightMembers.count(), false);
+	foreach (const JsonStructureIndex::Member &leftMember, _left.members(left))
+	{
+		QString key = _left.keyName(leftMember);
+		QHash<QString, int>::const_iterator it = rightKeys.constFind(key);
+		if (it == rightKeys.constEnd())
+		{
+			addChange(Removed, path + JsonStructureIndex::pathComponent(key), &leftMember, NULL);
+			continue;
+		}
+
+		matched[it.value()] = true;
+		const JsonStructureIndex::Member &rightMember = rightMembers.at(it.value());
+
+		// Only build the path when there is something to report underneath it.
+		if (identical(leftMember, rightMember))
+		{
+			continue;
+		}
+		compareMembers(leftMember, rightMember, path + JsonStructureIndex::pathComponent(key));
+	}
+
+	for (int i = 0; i < rightMembers.count(); i++)
+	{
+		if (!matched.at(i))
+		{
+			addChange(Added, path + JsonStructureIndex::pathComponent(_right.keyName(rightMembers.at(i))), NULL, &rightMembers.at(i));
+		}
+	}
+}
+
+void JsonDiff::compareArrays(int left, int right, const QString &path)
+{
+	QVector<JsonStructureIndex::Member> leftMembers = _left.members(left);
+	QVector<JsonStructureIndex::Member> rightMembers = _right.members(right);
+
+	int count = qMax(leftMembers.count(), rightMembers.count());
+	for (int i = 0; i < count; i++)
+	{
+		if (i < leftMembers.count() && i < rightMembers.count() && identical(leftMembers.at(i), rightMembers.at(i)))
+		{
+			continue;
+		}
+
+		QString elementPath = path + QString("[%1]").arg(i);
+		if (i >= leftMembers.count())
+		{
+			addChange(Added, elementPath, NULL, &rightMembers.at(i));
+		}
+		else if (i >= rightMembers.count())
+		{
+			addChange(Removed, elementPath, &leftMembers.at(i), NULL);
+		}
+		else
+		{
+			compareMembers(leftMembers.at(i), rightMembers.at(i), elementPath);
+		}
+	}
+}
+
+bool JsonDiff::identical(const JsonStructureIndex::Member &left, const JsonStructureIndex::Member &right) const
+{
+	if (left.container != -1 && right.container != -1)
+	{
+		const JsonStructureIndex::Container &leftContainer = _left.container(left.container);
+		const JsonStructureIndex::Container &rightContainer = _right.container(right.container);
+		return leftContainer.isArray == rightContainer.isArray && leftContainer.hash == rightContainer.hash;
+	}
+	if (left.container != -1 || right.container != -1)
+	{
+		return false;
+	}
+	return _left.text().midRef(left.valueStart, left.valueEnd - left.valueStart + 1) ==
+		   _right.text().midRef(right.valueStart, right.valueEnd - right.valueStart + 1);
+}
+
+void JsonDiff::addChange(ChangeType type, const QString &path, const JsonStructureIndex::Member *left, const JsonStructureIndex::Member *right)
+{
+	Change change;
+	change.type = type;
+	change.path = path;
+	change.leftOffset = left != NULL ? memberOffset(*left) : -1;
+	change.rightOffset = right != NULL ? memberOffset(*right) : -1;
+	_changes.append(change);
+}
+
+int JsonDiff::memberOffset(const JsonStructureIndex::Member &member)
+{
+	return member.keyStart != -1 ? member.keyStart : member.valueStart;
+}
@@ -0,0 +1,54 @@
+/**
+ * @file jsondiff.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Structural comparison of two indexed JSON documents.
+ */
+#ifndef JSONDIFF_H
+#define JSONDIFF_H
+
+#include <QVector>
+#include "jsonstructureindex.h"
+
+/**
+ * Walks two documents side by side, skipping any pair of subtrees with matching hashes.
+ * Object members are matched by key regardless of order, array elements by position.
+ */
+class JsonDiff
+{
+public:
+	enum ChangeType
+	{
+		Added,
+		Removed,
+		Changed
+	};
+
+	struct Change
+	{
+		ChangeType type;
+		QString path;
+		int leftOffset;			///< Offset of the value in the left document, or -1 if added.
+		int rightOffset;		///< Offset of the value in the right document, or -1 if removed.
+	};
+
+	static QVector<Change> compare(const JsonStructureIndex &left, const JsonStructureIndex &right);
+
+private:
+	JsonDiff(const JsonStructureIndex &left, const JsonStructureIndex &right);
+
+	void compareMembers(const JsonStructureIndex::Member &left, const JsonStructureIndex::Member &right, const QString &path);
+	void compareObjects(int left, int right, const QString &path);
+	void compareArrays(int left, int right, const QString &path);
+	bool identical(const JsonStructureIndex::Member &left, const JsonStructureIndex::Member &right) const;
+	void addChange(ChangeType type, const QString &path, const JsonStructureIndex::Member *left, const JsonStructureIndex::Member *right);
+
+	static int memberOffset(const JsonStructureIndex::Member &member);
+
+	const JsonStructureIndex &_left;
+	const JsonStructureIndex &_right;
+	QVector<Change> _changes;
+};
+
+#endif // JSONDIFF_H
@@ -0,0 +1,164 @@
+/**
+ * @file jsondiffdialog.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsondiffdialog.h"
+#include "jsoneditor.h"
+#include "jsonworkerpool.h"
+#include <QDateTime>
+#include <QListWidget>
+#include <QSplitter>
+#include <QVBoxLayout>
+#include <QScrollBar>
+
+JsonDiffDialog::JsonDiffDialog(QWidget *parent) :
+	QDialog(parent),
+	_synchronizing(false)
+{
+	setWindowTitle("Compare - JSONPad");
+	resize(1200, 800);
+
+	QFont font("Monospace");
+	font.setStyleHint(QFont::TypeWriter);
+
+	_leftEditor = new JsonEditor(this);
+	_leftEditor->setFont(font);
+	_leftEditor->setLineWrapMode(QPlainTextEdit::NoWrap);
+	_leftEditor->setReadOnly(true);
+
+	_rightEditor = new JsonEditor(this);
+	_rightEditor->setFont(font);
+	_rightEditor->setLineWrapMode(QPlainTextEdit::NoWrap);
+	_rightEditor->setReadOnly(true);
+
+	JsonFormatStyle style = JsonFormatStyle::load();
+	_leftEditor->setFormatStyle(style);
+	_rightEditor->setFormatStyle(style);
+
+	_changeList = new QListWidget(this);
+
+	QSplitter *editorSplitter = new QSplitter(Qt::Horizontal);
+	editorSplitter->addWidget(_leftEditor);
+	editorSplitter->addWidget(_rightEditor);
+
+	QSplitter *splitter = new QSplitter(Qt::Vertical);
+	splitter->addWidget(editorSplitter);
+	splitter->addWidget(_changeList);
+	splitter->setStretchFactor(0, 4);
+	splitter->setStretchFactor(1, 1);
+
+	setLayout(new QVBoxLayout());
+	layout()->addWidget(splitter);
+
+	connect(_changeList, &QListWidget::currentItemChanged, this, &JsonDiffDialog::changeSelected);
+	connect(_leftEditor->verticalScrollBar(), &QScrollBar::valueChanged, this, &JsonDiffDialog::leftScrolled);
+	connect(_rightEditor->verticalScrollBar(), &QScrollBar::valueChanged, this, &JsonDiffDialog::rightScrolled);
+}
+
+JsonDiffDialog::~JsonDiffDialog()
+{
+}
+
+void JsonDiffDialog::compare(const QString &leftTitle, const QString &leftText, const QString &rightTitle, const QString &rightText)
+{
+	setWindowTitle(QString("%1 - %2 - JSONPad").arg(leftTitle, rightTitle));
+
+	// Both sides are indexed once, side by side on the worker pool, and handed to the editors as they are.
+	qint64 timeStart = QDateTime::currentMSecsSinceEpoch();
+	JsonStructureIndex leftIndex;
+	JsonStructureIndex rightIndex;
+	QVector<JsonWorkerPool::Task> tasks;
+	tasks.append([&leftIndex, &leftText]() { leftIndex.build(leftText); });
+	tasks.append([&rightIndex, &rightText]() { rightIndex.build(rightText); });
+	JsonWorkerPool::instance().run(tasks);
+	qDebug("time to index both sides: %lld ms", QDateTime::currentMSecsSinceEpoch() - timeStart);
+
+	// The editors are still empty, so switching them to the formatted view first costs nothing.
+	_leftEditor->setFormatted(true);
+	_leftEditor->setIndexedText(leftIndex);
+	_rightEditor->setFormatted(true);
+	_rightEditor->setIndexedText(rightIndex);
+
+	_changes = JsonDiff::compare(_leftEditor->structureIndex(), _rightEditor->structureIndex());
+
+	_changeList->clear();
+	foreach (const JsonDiff::Change &change, _changes)
+	{
+		QListWidgetItem *item = new QListWidgetItem(_changeList);
+		switch (change.type)
+		{
+			case JsonDiff::Added:
+				item->setText("+ " + change.path);
+				item->setForeground(Qt::darkGreen);
+				break;
+			case JsonDiff::Removed:
+				item->setText("- " + change.path);
+				item->setForeground(Qt::darkRed);
+				break;
+			case JsonDiff::Changed:
+				item->setText("~ " + change.path);
+				item->setForeground(Qt::darkBlue);
+				break;
+		}
+	}
+
+	if (_changes.isEmpty())
+	{
+		new QListWidgetItem("The documents are structurally identical.", _changeList);
+	}
+}
+
+void JsonDiffDialog::changeSelected(QListWidgetItem *item)
+{
+	int row = _changeList->row(item);
+	if (row < 0 || row >= _changes.count())
+	{
+		return;
+	}
+
+	const JsonDiff::Change &change = _changes.at(row);
+
+	_synchronizing = true;
+	if (change.leftOffset != -1)
+	{
+		_leftEditor->setRawCursorPosition(change.leftOffset);
+	}
+	if (change.rightOffset != -1)
+	{
+		_rightEditor->setRawCursorPosition(change.rightOffset);
+	}
+	_synchronizing = false;
+}
+
+void JsonDiffDialog::leftScrolled()
+{
+	synchronizeScrolling(_leftEditor, _rightEditor);
+}
+
+void JsonDiffDialog::rightScrolled()
+{
+	synchronizeScrolling(_rightEditor, _leftEditor);
+}
+
+void JsonDiffDialog::synchronizeScrolling(JsonEditor *source, JsonEditor *target)
+{
+	if (_synchronizing)
+	{
+		return;
+	}
+
+	// Line numbers drift apart wherever the documents differ, so keep the same path at the top of both views.
+	QString path = source->structureIndex().pathAt(source->firstVisibleRawPosition());
+	int offset = target->structureIndex().offsetForPath(path);
+	if (offset == -1)
+	{
+		return;
+	}
+
+	_synchronizing = true;
+	target->scrollToRawPosition(offset);
+	_synchronizing = false;
+}
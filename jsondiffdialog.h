@@ -0,0 +1,43 @@
+/**
+ * @file jsondiffdialog.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Side by side view of the structural differences between two documents.
+ */
+#ifndef JSONDIFFDIALOG_H
+#define JSONDIFFDIALOG_H
+
+#include <QDialog>
+#include "jsondiff.h"
+
+class JsonEditor;
+class QListWidget;
+class QListWidgetItem;
+
+class JsonDiffDialog : public QDialog
+{
+	Q_OBJECT
+
+public:
+	explicit JsonDiffDialog(QWidget *parent = nullptr);
+	virtual ~JsonDiffDialog();
+
+	void compare(const QString &leftTitle, const QString &leftText, const QString &rightTitle, const QString &rightText);
+
+private slots:
+	void changeSelected(QListWidgetItem *item);
+	void leftScrolled();
+	void rightScrolled();
+
+private:
+	void synchronizeScrolling(JsonEditor *source, JsonEditor *target);
+
+	JsonEditor *_leftEditor;
+	JsonEditor *_rightEditor;
+	QListWidget *_changeList;
+	QVector<JsonDiff::Change> _changes;
+	bool _synchronizing;
+};
+
+#endif // JSONDIFFDIALOG_H
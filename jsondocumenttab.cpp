@@ -0,0 +1,258 @@
+/**
+ * @file jsondocumenttab.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsondocumenttab.h"
+#include "jsoneditor.h"
+#include "jsonjournal.h"
+#include "jsonindexcache.h"
+#include "jsonworkerpool.h"
+#include <QVBoxLayout>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QDateTime>
+
+JsonDocumentTab::JsonDocumentTab(QWidget *parent) :
+	QWidget(parent),
+	_editor(NULL),
+	_journal(NULL),
+	_unsavedChanges(false),
+	_followWatcher(NULL),
+	_followOffset(0)
+{
+	_editor = new JsonEditor(this);
+	QFont font = _editor->font();
+	font.setFamily("Monospace");
+	_editor->setFont(font);
+	_editor->setLineWrapMode(QPlainTextEdit::NoWrap);
+
+	QVBoxLayout *layout = new QVBoxLayout(this);
+	layout->setMargin(0);
+	layout->addWidget(_editor);
+
+	_journal = new JsonJournal(this);
+	_journal->resetToText(QString());
+
+	connect(_editor, &JsonEditor::textChanged, this, &JsonDocumentTab::documentChanged);
+	connect(_editor, &JsonEditor::rawTextEdited, _journal, &JsonJournal::record);
+	connect(_journal, &JsonJournal::compactionNeeded, this, &JsonDocumentTab::compactJournal);
+}
+
+JsonDocumentTab::~JsonDocumentTab()
+{
+}
+
+void JsonDocumentTab::load(Contents &contents)
+{
+	contents.loaded = false;
+
+	QFile file(contents.fileName);
+	if (!file.open(QFile::ReadOnly))
+	{
+		// Could not open the file for some reason!
+		return;
+	}
+
+	QByteArray data = file.readAll();
+	file.close();
+
+	// Reuse the index from a previous session when the file hasn't changed since.
+	QString text = QString::fromUtf8(data);
+	if (!JsonIndexCache::load(contents.fileName, data, text, contents.index, contents.folds))
+	{
+		contents.index.build(text);
+		contents.folds.clear();
+		JsonIndexCache::save(contents.fileName, data, contents.index);
+	}
+
+	contents.size = data.size();
+	contents.loaded = true;
+}
+
+void JsonDocumentTab::loadAll(QVector<Contents> &contents)
+{
+	// Files are read and indexed side by side on the worker pool.
+	qint64 timeStart = QDateTime::currentMSecsSinceEpoch();
+	QVector<JsonWorkerPool::Task> tasks;
+	for (int i = 0; i < contents.count(); i++)
+	{
+		Contents *file = &contents[i];
+		tasks.append([file]() { load(*file); });
+	}
+	JsonWorkerPool::instance().run(tasks);
+	if (!contents.isEmpty())
+	{
+		qDebug("time to read and index %d files: %lld ms", contents.count(), QDateTime::currentMSecsSinceEpoch() - timeStart);
+	}
+}
+
+void JsonDocumentTab::setContents(const Contents &contents)
+{
+	_editor->setIndexedText(contents.index, contents.folds);
+	_journal->resetToFile(contents.fileName);
+	_followOffset = contents.size;
+	_fileName = contents.fileName;
+	_unsavedChanges = false;
+	emit titleChanged();
+}
+
+JsonEditor *JsonDocumentTab::editor() const
+{
+	return _editor;
+}
+
+JsonJournal *JsonDocumentTab::journal() const
+{
+	return _journal;
+}
+
+QString JsonDocumentTab::fileName() const
+{
+	return _fileName;
+}
+
+void JsonDocumentTab::setFileName(const QString &fileName)
+{
+	_fileName = fileName;
+	emit titleChanged();
+}
+
+QString JsonDocumentTab::title() const
+{
+	QString documentName = _fileName.isEmpty() ? QString("New Document") : QFileInfo(_fileName).fileName();
+	if (_unsavedChanges)
+	{
+		documentName = "*" + documentName;
+	}
+	return documentName;
+}
+
+bool JsonDocumentTab::hasUnsavedChanges() const
+{
+	return _unsavedChanges;
+}
+
+void JsonDocumentTab::setUnsavedChanges(bool unsaved)
+{
+	_unsavedChanges = unsaved;
+	emit titleChanged();
+}
+
+bool JsonDocumentTab::isEmpty() const
+{
+	// A new document nobody has typed into yet can be replaced by an opened file.
+	return _fileName.isEmpty() && !_unsavedChanges && _editor->structureIndex().text().isEmpty();
+}
+
+bool JsonDocumentTab::isFollowing() const
+{
+	return _followWatcher != NULL;
+}
+
+void JsonDocumentTab::setFollowing(bool follow)
+{
+	if (follow == isFollowing())
+	{
+		return;
+	}
+
+	delete _followWatcher;
+	_followWatcher = NULL;
+	_editor->setReadOnly(follow);
+
+	if (follow)
+	{
+		_followWatcher = new QFileSystemWatcher(QStringList() << _fileName, this);
+		connect(_followWatcher, &QFileSystemWatcher::fileChanged, this, &JsonDocumentTab::readAppendedData);
+		readAppendedData();
+	}
+}
+
+void JsonDocumentTab::setFollowOffset(qint64 offset)
+{
+	_followOffset = offset;
+}
+
+void JsonDocumentTab::saveFoldState()
+{
+	// Fold state is only kept for documents that still match the file on disk.
+	if (!_fileName.isEmpty() && !_unsavedChanges)
+	{
+		JsonIndexCache::saveFolds(_fileName, _editor->foldedContainers());
+	}
+}
+
+void JsonDocumentTab::documentChanged()
+{
+	if (!_unsavedChanges)
+	{
+		setUnsavedChanges(true);
+	}
+}
+
+void JsonDocumentTab::compactJournal()
+{
+	_journal->resetToText(_editor->structureIndex().text());
+}
+
+void JsonDocumentTab::readAppendedData()
+{
+	QFile file(_fileName);
+	if (!file.open(QFile::ReadOnly))
+	{
+		return;
+	}
+
+	// Files that are replaced rather than appended to drop out of the watcher.
+	if (!_followWatcher->files().contains(file.fileName()))
+	{
+		_followWatcher->addPath(file.fileName());
+	}
+
+	if (file.size() < _followOffset)
+	{
+		// The file was truncated or rotated, so start over.
+		QByteArray contents = file.readAll();
+		_editor->setText(contents);
+		_followOffset = contents.size();
+		rebaseJournal();
+		return;
+	}
+
+	if (file.size() == _followOffset || !file.seek(_followOffset))
+	{
+		return;
+	}
+
+	// Only take complete lines, so a record or a UTF-8 sequence is never split between reads.
+	QByteArray appended = file.read(file.size() - _followOffset);
+	int lastNewline = appended.lastIndexOf('\n');
+	if (lastNewline == -1)
+	{
+		return;
+	}
+	appended.truncate(lastNewline + 1);
+
+	_followOffset += appended.size();
+	_editor->appendText(QString::fromUtf8(appended));
+	rebaseJournal();
+}
+
+void JsonDocumentTab::rebaseJournal()
+{
+	// Text read from the file isn't journaled, and the file no longer matches the size and
+	// time the journal was based on, so recovery would drop every edit.  A document without
+	// edits is based on the file again; one with edits keeps its whole text as the base.
+	if (_unsavedChanges)
+	{
+		_journal->resetToText(_editor->structureIndex().text());
+	}
+	else
+	{
+		_journal->resetToFile(_fileName);
+	}
+}
@@ -0,0 +1,82 @@
+/**
+ * @file jsondocumenttab.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief One open document: its editor, file, journal and follow state.
+ */
+#ifndef JSONDOCUMENTTAB_H
+#define JSONDOCUMENTTAB_H
+
+#include <QWidget>
+#include <QBitArray>
+#include "jsonstructureindex.h"
+
+class QFileSystemWatcher;
+class JsonEditor;
+class JsonJournal;
+
+class JsonDocumentTab : public QWidget
+{
+	Q_OBJECT
+
+public:
+	/**
+	 * A JSON file read and indexed by load(), which only touches its arguments and the
+	 * index cache, so any number of files can be loaded at once on the worker pool.
+	 */
+	struct Contents
+	{
+		QString fileName;
+		qint64 size;
+		JsonStructureIndex index;
+		QBitArray folds;
+		bool loaded;
+	};
+
+	explicit JsonDocumentTab(QWidget *parent = nullptr);
+	virtual ~JsonDocumentTab();
+
+	static void load(Contents &contents);
+	static void loadAll(QVector<Contents> &contents);
+	void setContents(const Contents &contents);
+
+	JsonEditor *editor() const;
+	JsonJournal *journal() const;
+
+	QString fileName() const;
+	void setFileName(const QString &fileName);
+	QString title() const;
+
+	bool hasUnsavedChanges() const;
+	void setUnsavedChanges(bool unsaved);
+	bool isEmpty() const;
+
+	bool isFollowing() const;
+	void setFollowing(bool follow);
+	void setFollowOffset(qint64 offset);
+
+	void saveFoldState();
+
+signals:
+	void titleChanged();
+
+private slots:
+	void documentChanged();
+	void compactJournal();
+	void readAppendedData();
+
+private:
+	void rebaseJournal();
+
+	JsonEditor *_editor;
+	JsonJournal *_journal;
+
+	QString _fileName;
+	bool _unsavedChanges;
+
+	QFileSystemWatcher *_followWatcher;
+	qint64 _followOffset;
+};
+
+#endif // JSONDOCUMENTTAB_H
@@ -9,17 +9,28 @@
 #include <QJsonDocument>
 #include <QFontMetrics>
 #include <QKeyEvent>
-#include <QRegularExpression>
 #include <QLayout>
 #include <QApplication>
 #include <QTimer>
 #include <QPainter>
 #include <QMainWindow>
 #include <QScrollBar>
+#include <QTextBlock>
 #include <QDateTime>
+#include <QMimeData>
+#include <algorithm>
 
-#define HIDDEN_CHAR		'\31'
-#define ELLIPSES		"\u2060\u2026\u2060"
+// Rough cost of laying out one line of the view, on top of its characters.
+#define LAYOUT_BYTES_PER_BLOCK		256
+// Rough cost of a line of the raw text, which is never laid out.
+#define TEXT_BYTES_PER_BLOCK		64
+// Rough cost of one undo step; Qt keeps the text of each step but doesn't say how much.
+#define UNDO_BYTES_PER_STEP			128
+
+static inline qint64 undoHistorySize(const QTextDocument *document)
+{
+	return qint64(document->availableUndoSteps() + document->availableRedoSteps()) * UNDO_BYTES_PER_STEP;
+}
 
 JsonMarginWidget::JsonMarginWidget(JsonEditor *parent) :
 	QWidget(parent),
@@ -40,6 +51,12 @@ void JsonMarginWidget::paintEvent(QPaintEvent *e)
 JsonEditor::JsonEditor(QWidget *parent) :
 	QPlainTextEdit(parent),
 	_formatDocument(false),
+	_replacingText(false),
+	_derivedDataReleased(false),
+	_releasedCursorPosition(0),
+	_releasedScrollPosition(0),
+	_memoryCap(0),
+	_degradeLevel(FullView),
 	_unformattedTextEdit(NULL)
 {
 	setViewportMargins(20, 0, 0, 0);
@@ -56,6 +73,9 @@ JsonEditor::JsonEditor(QWidget *parent) :
 	layout()->addItem(new QSpacerItem(10, 0, QSizePolicy::Expanding, QSizePolicy::Fixed));
 
 	connect(this, &QPlainTextEdit::textChanged, this, &JsonEditor::updateText);
+	connect(this, &QPlainTextEdit::cursorPositionChanged, this, &JsonEditor::updateRawCursorPosition);
+	connect(document(), &QTextDocument::contentsChange, this, &JsonEditor::visibleContentsChanged);
+	connect(this, &JsonEditor::structureIndexChanged, this, &JsonEditor::enforceMemoryCap);
 	emit documentFormatted(false);
 }
 
@@ -65,50 +85,460 @@ JsonEditor::~JsonEditor()
 
 void JsonEditor::setText(const QString &text)
 {
-	if (_unformattedTextEdit == NULL)
-	{
-		_unformattedTextEdit = new QPlainTextEdit();
-		_unformattedTextEdit->setEnabled(true);
-	}
+	createUnformattedTextEdit();
+
+	_replacingText = true;
 	_unformattedTextEdit->setPlainText(text);
+	_replacingText = false;
 	setFormatted(_formatDocument);
 }
 
-QString JsonEditor::text()
+void JsonEditor::setIndexedText(const JsonStructureIndex &index, const QBitArray &folds)
+{
+	createUnformattedTextEdit();
+
+	// A newly opened file starts over with everything kept.
+	if (_degradeLevel != FullView)
+	{
+		_degradeLevel = FullView;
+		setUndoHistoryEnabled(true);
+	}
+
+	// The text was indexed already, so it only needs formatting.
+	_structureIndex = index;
+	_expandedStrings.clear();
+	if (_formatDocument && folds.count(true) > 0)
+	{
+		_structureIndex.setFolds(folds, 0);
+	}
+	_replacingText = true;
+	_unformattedTextEdit->setPlainText(_structureIndex.text());
+	_replacingText = false;
+	updateFormatting(_formatDocument);
+}
+
+void JsonEditor::appendText(const QString &text)
 {
+	if (text.isEmpty())
+	{
+		return;
+	}
 	if (_unformattedTextEdit == NULL)
 	{
-		_unformattedTextEdit = new QPlainTextEdit(this);
-		_unformattedTextEdit->setEnabled(true);
+		setText(text);
+		return;
 	}
+
+	// Keep following the end of the document if that's where the view already is.
+	bool following = verticalScrollBar()->value() == verticalScrollBar()->maximum();
+	bool atTopLevel = _structureIndex.isAtTopLevel();
+
+	_replacingText = true;
+	QTextCursor rawCursor(_unformattedTextEdit->document());
+	rawCursor.movePosition(QTextCursor::End);
+	rawCursor.insertText(text);
+	_replacingText = false;
+
+	int unformattedFrom = _structureIndex.text().length();
+	_structureIndex.append(text);
+
+	if (_derivedDataReleased)
+	{
+		// The view is rebuilt from the whole text when it is restored.
+		emit structureIndexChanged();
+	}
+	else if (_formatDocument && (!atTopLevel || _formatStyle.sortKeys))
+	{
+		// The new text continues an open container, so the formatter has no state to resume from.
+		// Sorted documents are always reformatted, as the sorted text is built from the whole index.
+		setFormatted(true);
+	}
+	else
+	{
+		QString tail = text;
+		if (_formatDocument)
+		{
+			// Each appended batch of top-level values is formatted on its own.
+			tail = formattedText(text, _formatStyle);
+			if (!_formattedText.isEmpty() && !tail.isEmpty())
+			{
+				tail.prepend('\n');
+			}
+
+			int formattedFrom = _formattedText.length();
+			_formattedText += tail;
+			_positionMap.append(unformattedFrom, formattedFrom, _structureIndex.text(), _formattedText);
+		}
+
+		blockSignals(true);
+		_replacingText = true;
+		QTextCursor cursor(document());
+		cursor.movePosition(QTextCursor::End);
+		cursor.insertText(tail);
+		_replacingText = false;
+		blockSignals(false);
+
+		_marginWidget->update();
+		emit structureIndexChanged();
+	}
+
+	if (following)
+	{
+		verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+	}
+}
+
+QString JsonEditor::text()
+{
+	createUnformattedTextEdit();
 	return _unformattedTextEdit->toPlainText();
 }
 
+void JsonEditor::createUnformattedTextEdit()
+{
+	if (_unformattedTextEdit != NULL)
+	{
+		return;
+	}
+
+	// Holds the raw text behind the formatted view; it is never shown.
+	_unformattedTextEdit = new QPlainTextEdit(this);
+	_unformattedTextEdit->hide();
+	_unformattedTextEdit->setEnabled(true);
+	connect(_unformattedTextEdit->document(), &QTextDocument::contentsChange, this, &JsonEditor::rawContentsChanged);
+}
+
+const JsonStructureIndex &JsonEditor::structureIndex() const
+{
+	return _structureIndex;
+}
+
+const JsonFormatStyle &JsonEditor::formatStyle() const
+{
+	return _formatStyle;
+}
+
+void JsonEditor::setFormatStyle(const JsonFormatStyle &style)
+{
+	if (_formatStyle == style)
+	{
+		return;
+	}
+
+	// Keep the cursor on the same raw position across the change of layout.
+	int rawPosition = rawCursorPosition();
+	_formatStyle = style;
+	if (_unformattedTextEdit != NULL && !_derivedDataReleased)
+	{
+		setFormatted(_formatDocument);
+		setRawCursorPosition(rawPosition);
+	}
+}
+
+bool JsonEditor::isFormatted() const
+{
+	return _formatDocument;
+}
+
+qint64 JsonEditor::derivedDataSize() const
+{
+	if (!_formatDocument || _derivedDataReleased)
+	{
+		return 0;
+	}
+
+	// Everything here can be rebuilt from the raw text and the structure index.
+	return qint64(_formattedText.capacity() + _sortedText.capacity()) * qint64(sizeof(QChar)) +
+		   qint64(document()->characterCount()) * qint64(sizeof(QChar)) +
+		   qint64(document()->blockCount()) * LAYOUT_BYTES_PER_BLOCK +
+		   _positionMap.memoryUsage() + _keySorter.memoryUsage();
+}
+
+bool JsonEditor::isDerivedDataReleased() const
+{
+	return _derivedDataReleased;
+}
+
+void JsonEditor::releaseDerivedData()
+{
+	// The view of an unformatted document is the document itself, along with its undo history.
+	if (_derivedDataReleased || !_formatDocument || _unformattedTextEdit == NULL)
+	{
+		return;
+	}
+
+	_releasedCursorPosition = rawCursorPosition();
+	_releasedScrollPosition = firstVisibleRawPosition();
+
+	_formattedText = QString();
+	_sortedText = QString();
+	_keySorter.clear();
+	_positionMap.clear();
+
+	blockSignals(true);
+	_replacingText = true;
+	QPlainTextEdit::setPlainText(QString());
+	_replacingText = false;
+	blockSignals(false);
+
+	_derivedDataReleased = true;
+}
+
+void JsonEditor::restoreDerivedData()
+{
+	if (!_derivedDataReleased)
+	{
+		return;
+	}
+
+	qint64 timeStart = QDateTime::currentMSecsSinceEpoch();
+
+	updateFormatting(true);
+	setRawCursorPosition(_releasedCursorPosition);
+	scrollToRawPosition(_releasedScrollPosition);
+
+	qDebug("time to restore formatted view: %lld ms", QDateTime::currentMSecsSinceEpoch() - timeStart);
+}
+
+JsonMemoryUsage JsonEditor::memoryUsage() const
+{
+	JsonMemoryUsage usage;
+
+	// The raw text is held by the index and by the document behind the view.
+	usage.add(JsonMemoryUsage::RawText, qint64(_structureIndex.text().capacity()) * qint64(sizeof(QChar)));
+	if (_unformattedTextEdit != NULL)
+	{
+		const QTextDocument *raw = _unformattedTextEdit->document();
+		usage.add(JsonMemoryUsage::RawText, qint64(raw->characterCount()) * qint64(sizeof(QChar)));
+		usage.add(JsonMemoryUsage::Layout, qint64(raw->blockCount()) * TEXT_BYTES_PER_BLOCK);
+		usage.add(JsonMemoryUsage::UndoHistory, undoHistorySize(raw));
+	}
+
+	// Without formatting, the view is one more copy of the raw text.
+	usage.add(_formatDocument ? JsonMemoryUsage::FormattedText : JsonMemoryUsage::RawText,
+			  qint64(_formattedText.capacity() + document()->characterCount()) * qint64(sizeof(QChar)));
+	usage.add(JsonMemoryUsage::Layout, qint64(document()->blockCount()) * LAYOUT_BYTES_PER_BLOCK);
+	usage.add(JsonMemoryUsage::UndoHistory, undoHistorySize(document()));
+
+	usage.add(JsonMemoryUsage::Indexes, _structureIndex.memoryUsage() + _positionMap.memoryUsage());
+	usage.add(JsonMemoryUsage::Caches, qint64(_sortedText.capacity()) * qint64(sizeof(QChar)) + _keySorter.memoryUsage() +
+			  qint64(_expandedStrings.capacity()) * qint64(sizeof(int)));
+	return usage;
+}
+
+JsonEditor::DegradeLevel JsonEditor::degradeLevel() const
+{
+	return _degradeLevel;
+}
+
+void JsonEditor::setMemoryCap(qint64 bytes)
+{
+	// A new cap starts over with undo kept; the formatted view comes back when it is turned on again.
+	_memoryCap = bytes;
+	if (_degradeLevel != FullView)
+	{
+		_degradeLevel = FullView;
+		setUndoHistoryEnabled(true);
+	}
+	enforceMemoryCap();
+}
+
+void JsonEditor::enforceMemoryCap()
+{
+	// A released view is checked again once it is restored.
+	if (_memoryCap <= 0 || _unformattedTextEdit == NULL || _derivedDataReleased)
+	{
+		return;
+	}
+
+	// Each level is only reached if the one before it wasn't enough, and is never left on its own,
+	// so formatting turned back on by hand stays on.
+	if (_degradeLevel < WithoutUndo && memoryUsage().total() > _memoryCap)
+	{
+		_degradeLevel = WithoutUndo;
+		setUndoHistoryEnabled(false);
+		emit degraded(_degradeLevel);
+	}
+	if (_degradeLevel < WithoutFormatting && memoryUsage().total() > _memoryCap)
+	{
+		_degradeLevel = WithoutFormatting;
+		if (_formatDocument)
+		{
+			int rawPosition = rawCursorPosition();
+			setFormatted(false);
+			setRawCursorPosition(rawPosition);
+		}
+		emit degraded(_degradeLevel);
+	}
+}
+
+void JsonEditor::setUndoHistoryEnabled(bool enabled)
+{
+	// Turning undo off also drops the history kept so far.
+	document()->setUndoRedoEnabled(enabled);
+	if (_unformattedTextEdit != NULL)
+	{
+		_unformattedTextEdit->document()->setUndoRedoEnabled(enabled);
+	}
+}
+
+int JsonEditor::rawCursorPosition()
+{
+	if (_derivedDataReleased)
+	{
+		return _releasedCursorPosition;
+	}
+	return _formatDocument ? unformattedPosition(textCursor().position()) : textCursor().position();
+}
+
+int JsonEditor::firstVisibleRawPosition()
+{
+	if (_derivedDataReleased)
+	{
+		return _releasedScrollPosition;
+	}
+	int position = firstVisibleBlock().position();
+	return _formatDocument ? unformattedPosition(position) : position;
+}
+
+void JsonEditor::scrollToRawPosition(int position)
+{
+	// Without line wrapping the vertical scroll bar counts lines.
+	QTextBlock block = document()->findBlock(_formatDocument ? formattedPosition(position) : position);
+	if (block.isValid())
+	{
+		verticalScrollBar()->setValue(block.blockNumber());
+	}
+}
+
+void JsonEditor::setRawCursorPosition(int position)
+{
+	QTextCursor cursor = textCursor();
+	cursor.setPosition(qBound(0, _formatDocument ? formattedPosition(position) : position, document()->characterCount() - 1));
+	setTextCursor(cursor);
+	ensureCursorVisible();
+}
+
+void JsonEditor::foldAll()
+{
+	QBitArray folds(_structureIndex.containerCount());
+	for (int i = 0; i < _structureIndex.containerCount(); i++)
+	{
+		const JsonStructureIndex::Container &container = _structureIndex.container(i);
+		folds.setBit(i, !container.isArray && container.depth > 0);
+	}
+	applyFolds(folds);
+	ensureCursorVisible();
+}
+
+void JsonEditor::unfoldAll()
+{
+	applyFolds(QBitArray(_structureIndex.containerCount()));
+	ensureCursorVisible();
+}
+
+void JsonEditor::foldToDepth(int depth)
+{
+	// Fold the outermost objects at or below the given depth, leaving everything inside them as it is.
+	QBitArray folds(_structureIndex.containerCount());
+	QBitArray covered(_structureIndex.containerCount());
+	for (int i = 0; i < _structureIndex.containerCount(); i++)
+	{
+		const JsonStructureIndex::Container &container = _structureIndex.container(i);
+		if (container.parent != -1 && (covered.testBit(container.parent) || folds.testBit(container.parent)))
+		{
+			covered.setBit(i);
+		}
+		else if (!container.isArray && container.depth >= depth)
+		{
+			folds.setBit(i);
+		}
+	}
+	applyFolds(folds);
+	ensureCursorVisible();
+}
+
+QBitArray JsonEditor::foldedContainers() const
+{
+	QBitArray folds(_structureIndex.containerCount());
+	for (int i = 0; i < _structureIndex.containerCount(); i++)
+	{
+		folds.setBit(i, _structureIndex.container(i).folded);
+	}
+	return folds;
+}
+
+void JsonEditor::applyFolds(const QBitArray &folds)
+{
+	if (!_formatDocument || _unformattedTextEdit == NULL)
+	{
+		return;
+	}
+
+	// Folding only moves offsets around, so the index is updated in place rather than rebuilt.
+	int newCursorPosition = _structureIndex.setFolds(folds, rawCursorPosition());
+
+	int scrollBarPosition = verticalScrollBar()->value();
+	_replacingText = true;
+	_unformattedTextEdit->setPlainText(_structureIndex.text());
+	_replacingText = false;
+	updateFormatting(true);
+
+	QTextCursor cursor = textCursor();
+	cursor.setPosition(qBound(0, formattedPosition(newCursorPosition), document()->characterCount() - 1));
+	setTextCursor(cursor);
+	verticalScrollBar()->setValue(scrollBarPosition);
+}
+
 void JsonEditor::setFormatted(bool formatted)
 {
-	// Set tab width to four spaces.
-	setTabStopWidth(QFontMetrics(font()).width("    "));
+	_structureIndex.build(text());
+	updateFormatting(formatted);
+}
+
+void JsonEditor::updateFormatting(bool formatted)
+{
+	// Tabs are as wide as one level of indentation.
+	setTabStopWidth(QFontMetrics(font()).width(QString(_formatStyle.indentWidth, ' ')));
 
 	bool formattingChanged = _formatDocument != formatted;
 	_formatDocument = formatted;
+	_derivedDataReleased = false;
 
 	int scrollBarPosition = verticalScrollBar()->value();
+
 	blockSignals(true);
 	if (_formatDocument)
 	{
-		_formattedText = formattedText(text());
+		if (_formatStyle.sortKeys)
+		{
+			_sortedText = _keySorter.sort(_structureIndex);
+		}
+		else
+		{
+			_sortedText.clear();
+			_keySorter.clear();
+		}
+
+		_formattedText = JsonFormatter::format(formatSource(), _formatStyle, formatSourceRootStarts(), formatSourceExpandedStrings());
+#ifdef JSONPAD_FORMATTER_BENCHMARK
+		JsonFormatter::benchmark(formatSource());
+#endif
+		_positionMap.build(formatSource(), _formattedText);
 
 		int cursorPosition = formattingChanged ? formattedPosition(textCursor().position()) : textCursor().position();
 		int anchorPosition = formattingChanged ? (textCursor().anchor() != textCursor().position() ? formattedPosition(textCursor().anchor()) : cursorPosition) : textCursor().anchor();
 
-		if (text() != _formattedText)
+		if (_structureIndex.text() != _formattedText)
 		{
 			QTextCharFormat format = currentCharFormat();
 			format.setForeground(Qt::darkBlue);
 			setCurrentCharFormat(format);
 		}
 
+		_replacingText = true;
 		QPlainTextEdit::setPlainText(_formattedText);
+		_replacingText = false;
 
 		QTextCursor cursor = textCursor();
 		cursor.setPosition(anchorPosition);
@@ -125,14 +555,22 @@ void JsonEditor::setFormatted(bool formatted)
 	}
 	else
 	{
-		int cursorPosition = unformattedPosition(textCursor().position());
-		int anchorPosition = textCursor().anchor() != textCursor().position() ? unformattedPosition(textCursor().anchor()) : cursorPosition;
+		int cursorPosition = formattingChanged ? unformattedPosition(textCursor().position()) : textCursor().position();
+		int anchorPosition = formattingChanged ? (textCursor().anchor() != textCursor().position() ? unformattedPosition(textCursor().anchor()) : cursorPosition) : textCursor().anchor();
+
+		// The formatted text isn't needed until the document is formatted again.
+		_formattedText = QString();
+		_sortedText = QString();
+		_keySorter.clear();
+		_positionMap.clear();
 
 		QTextCharFormat format = currentCharFormat();
 		format.setForeground(Qt::black);
 		setCurrentCharFormat(format);
 
-		QPlainTextEdit::setPlainText(text());
+		_replacingText = true;
+		QPlainTextEdit::setPlainText(_structureIndex.text());
+		_replacingText = false;
 
 		QTextCursor cursor = textCursor();
 		cursor.setPosition(anchorPosition);
@@ -152,12 +590,17 @@ void JsonEditor::setFormatted(bool formatted)
 
 	verticalScrollBar()->setValue(scrollBarPosition);
 	_marginWidget->update();
+
+	emit structureIndexChanged();
 }
 
 void JsonEditor::keyPressEvent(QKeyEvent *keyEvent)
 {
-	if (_formatDocument && !keyEvent->text().isEmpty())
+	if (_formatDocument && !keyEvent->text().isEmpty() && !keyEvent->matches(QKeySequence::Copy))
 	{
+		// A shortened string is shown in full once it is edited.
+		expandStringAt(textCursor().position());
+
 		int cursorPosition = unformattedPosition(textCursor().position());
 		int anchorPosition = textCursor().anchor() != textCursor().position() ? unformattedPosition(textCursor().anchor()) : cursorPosition;
 
@@ -181,7 +624,7 @@ void JsonEditor::keyPressEvent(QKeyEvent *keyEvent)
 		// Skip closing quotes and braces.
 		if (keyEvent->text() == "\"" || keyEvent->text() == "}" || keyEvent->text() == "]")
 		{
-			if (text().length() > newCursor.position() && text().at(newCursor.position()) == keyEvent->text())
+			if (_structureIndex.text().length() > newCursor.position() && _structureIndex.text().at(newCursor.position()) == keyEvent->text())
 			{
 				skipCharacter = true;
 				cursorOffset = -1;
@@ -230,6 +673,54 @@ void JsonEditor::keyPressEvent(QKeyEvent *keyEvent)
 	}
 }
 
+void JsonEditor::mouseDoubleClickEvent(QMouseEvent *e)
+{
+	if (_formatDocument && expandStringAt(cursorForPosition(e->pos()).position()))
+	{
+		int rawPosition = unformattedPosition(cursorForPosition(e->pos()).position());
+		updateFormatting(true);
+		setRawCursorPosition(rawPosition);
+		return;
+	}
+	QPlainTextEdit::mouseDoubleClickEvent(e);
+}
+
+QMimeData *JsonEditor::createMimeDataFromSelection() const
+{
+	QTextCursor cursor = textCursor();
+	QVector<JsonPositionMap::Truncation> truncations;
+	if (_formatDocument)
+	{
+		truncations = _positionMap.truncations(cursor.selectionStart(), cursor.selectionEnd());
+	}
+	if (truncations.isEmpty())
+	{
+		return QPlainTextEdit::createMimeDataFromSelection();
+	}
+
+	// Shortened strings are copied whole, with the hidden part taken from the source text.
+	QString text;
+	int from = cursor.selectionStart();
+	for (int i = 0; i < truncations.count(); i++)
+	{
+		const JsonPositionMap::Truncation &truncation = truncations.at(i);
+		if (from < truncation.formattedStart)
+		{
+			text += _formattedText.midRef(from, truncation.formattedStart - from);
+		}
+		text += formatSource().midRef(truncation.unformattedStart, truncation.unformattedEnd - truncation.unformattedStart);
+		from = truncation.formattedEnd;
+	}
+	if (from < cursor.selectionEnd())
+	{
+		text += _formattedText.midRef(from, cursor.selectionEnd() - from);
+	}
+
+	QMimeData *data = new QMimeData();
+	data->setText(text);
+	return data;
+}
+
 void JsonEditor::paintEvent(QPaintEvent *e)
 {
 	QPlainTextEdit::paintEvent(e);
@@ -243,131 +734,18 @@ bool JsonEditor::eventFilter(QObject *object, QEvent *event)
 		QMouseEvent *mouseEvent = static_cast<QMouseEvent *>(event);
 
 		int lineIndex = positionOverLine(mouseEvent->pos());
-		QStringList lines = _formattedText.split("\n");
-		if (lineIndex != -1 && lineIndex < lines.count())
+		QTextBlock block = document()->findBlockByNumber(lineIndex);
+		if (lineIndex != -1 && block.isValid())
 		{
-			int firstInsertionPosition, secondInsertionPosition;
-
-			// Get the index of the '{' character within the clicked line...
-			int characterPosition = -1;
-			for (int i = 0; i < lineIndex; i++)
-			{
-				characterPosition = _formattedText.indexOf('\n', characterPosition + 1);
-			}
-			characterPosition = _formattedText.indexOf('{', characterPosition + 1);
-
-			// Check if this bracket is within a quote.
-			int quoteCount = _formattedText.mid(0, characterPosition).count("\"") -
-							 _formattedText.mid(0, characterPosition).count("\\\"");
-
-			// If we're at an odd number of quotes, we're inside a string so bail.
-			if (quoteCount % 2 == 1)
+			int container = containerOnLine(block);
+			if (container != -1)
 			{
-				return false;
-			}
-
-			// Insert the first hidden char here.
-			firstInsertionPosition = unformattedPosition(characterPosition + 1);
-
-			int previousCursorPosition;
-			QString previousText;
-
-			// If the section is already compressed, we're expanding it.
-			if (_formattedText.mid(characterPosition + 2, 3) == ELLIPSES)
-			{
-				characterPosition = firstInsertionPosition;
-				QString unformattedText = _unformattedTextEdit->toPlainText();
-
-				int braceLevel = 1;
-				bool insideQuotes = false;
-
-				// First split by quotation marks. (But not by quotation marks preceded by a backslash)
-				foreach (QString const &item, unformattedText.mid(characterPosition, unformattedText.length() - characterPosition).split(QRegularExpression(R"((?<!\\)\")")))
-				{
-					if (!insideQuotes)
-					{
-						for (int i = 0; i < item.length(); i++)
-						{
-							if (item.at(i) == '{')
-							{
-								braceLevel++;
-							}
-							else if (item.at(i) == '}')
-							{
-								braceLevel--;
-							}
-
-							if (braceLevel == 0)
-							{
-								characterPosition += i;
-								break;
-							}
-						}
-					}
-
-					if (braceLevel > 0)
-					{
-						characterPosition += item.length();
-						if (insideQuotes)
-						{
-							characterPosition += 2;
-						}
-					}
-					insideQuotes = !insideQuotes;
-				}
-
-				secondInsertionPosition = characterPosition - 1;
-
-				QTextCursor cursor = _unformattedTextEdit->textCursor();
-				cursor.setPosition(secondInsertionPosition);
-				cursor.deleteChar();
-
-				cursor.setPosition(firstInsertionPosition);
-				cursor.deleteChar();
-			}
-			// Otherwise we're compressing this section.
-			else
-			{
-				int braceLevel = 1;
-
-				// Now find the matching '}'...
-				for (int i = lineIndex + 1; i < lines.count() && braceLevel > 0; i++)
-				{
-					characterPosition = _formattedText.indexOf('\n', characterPosition + 1);
-
-					if (lines.at(i).endsWith("{"))
-					{
-						braceLevel++;
-					}
-					else if (lines.at(i).endsWith("}") || lines.at(i).endsWith("},"))
-					{
-						if (!lines.at(i).endsWith("{ " ELLIPSES " }"))
-						{
-							braceLevel--;
-						}
-					}
-				}
-				characterPosition = _formattedText.indexOf('}', characterPosition + 1);
-
-				// Insert the second hidden char here.
-				secondInsertionPosition = unformattedPosition(characterPosition + 1) - 1;
-
-				QTextCursor cursor = _unformattedTextEdit->textCursor();
-				previousCursorPosition = cursor.position();
-				previousText = _formattedText;
-
-				cursor.setPosition(secondInsertionPosition);
-				_unformattedTextEdit->setTextCursor(cursor);
-				_unformattedTextEdit->insertPlainText(QString(HIDDEN_CHAR));
-
-				cursor.setPosition(firstInsertionPosition);
-				_unformattedTextEdit->setTextCursor(cursor);
-				_unformattedTextEdit->insertPlainText(QString(HIDDEN_CHAR));
+				QBitArray folds = foldedContainers();
+				folds.toggleBit(container);
+				applyFolds(folds);
+				return true;
 			}
-			setFormatted(true);
-
-			textCursor().setPosition(cursorPositionHelper(previousCursorPosition, previousText, _formattedText));
-			return true;
+			return false;
 		}
 
 	}
@@ -385,6 +763,55 @@ void JsonEditor::updateText()
 	_marginWidget->update();
 }
 
+void JsonEditor::rawContentsChanged(int position, int charsRemoved, int charsAdded)
+{
+	// Keys typed into the formatted view are forwarded to the raw text.
+	if (!_replacingText)
+	{
+		reportRawEdit(_unformattedTextEdit->document(), position, charsRemoved, charsAdded);
+	}
+}
+
+void JsonEditor::visibleContentsChanged(int position, int charsRemoved, int charsAdded)
+{
+	// Without formatting the view is the raw text.
+	if (!_replacingText && !_formatDocument)
+	{
+		reportRawEdit(document(), position, charsRemoved, charsAdded);
+	}
+}
+
+void JsonEditor::reportRawEdit(QTextDocument *document, int position, int charsRemoved, int charsAdded)
+{
+	// The index still describes the text before the edit, so it can place the fold markers.
+	int contentLength = document->characterCount() - 1;
+	QString added;
+	added.reserve(charsAdded);
+	for (int i = position; i < position + charsAdded && i < contentLength; i++)
+	{
+		QChar c = document->characterAt(i);
+		if (c == QChar::ParagraphSeparator)
+		{
+			c = '\n';
+		}
+		if (c != HIDDEN_CHAR)
+		{
+			added += c;
+		}
+	}
+
+	int start = position - _structureIndex.markersBefore(position);
+	int end = position + charsRemoved;
+	end -= _structureIndex.markersBefore(end);
+	shiftExpandedStrings(start, end - start, added.length());
+	emit rawTextEdited(start, end - start, added);
+}
+
+void JsonEditor::updateRawCursorPosition()
+{
+	emit rawCursorPositionChanged(rawCursorPosition());
+}
+
 void JsonEditor::paintMarginWidget(QPaintEvent *)
 {
 	if (_formatDocument)
@@ -393,17 +820,20 @@ void JsonEditor::paintMarginWidget(QPaintEvent *)
 
 		p.setPen(Qt::black);
 
+		// Only the lines in view are looked at, straight from the document.
 		QFontMetrics metrics(font());
-		QStringList lines = _formattedText.split("\n");
-		for (int i = 0; i < lines.count(); i++)
+		int lastVisibleLine = verticalScrollBar()->value() + _marginWidget->height() / metrics.height() + 1;
+		for (QTextBlock block = firstVisibleBlock(); block.isValid() && block.blockNumber() <= lastVisibleLine; block = block.next())
 		{
-			if (lines.at(i).contains("{"))
+			int container = containerOnLine(block);
+			if (container != -1)
 			{
-				int yCoord = ((i + 1) * metrics.height()) - (verticalScrollBar()->value() * metrics.height()) - (metrics.height() / 2) + 1;
+				int yCoord = ((block.blockNumber() + 1) * metrics.height()) - (verticalScrollBar()->value() * metrics.height()) - (metrics.height() / 2) + 1;
 				p.drawLine(8, yCoord + 3, 12, yCoord + 3);
 				p.drawEllipse(7, yCoord, 6, 6);
 
-				if (lines.at(i).contains(ELLIPSES))
+				// Asking the index, as ELLIPSES on the line may just as well end a shortened string.
+				if (_structureIndex.container(container).folded)
 				{
 					p.drawLine(10, yCoord, 10, yCoord + 6);
 				}
@@ -412,272 +842,130 @@ void JsonEditor::paintMarginWidget(QPaintEvent *)
 	}
 }
 
+int JsonEditor::containerOnLine(const QTextBlock &block)
+{
+	// The first '{' within the line that actually opens an object.
+	QString line = block.text();
+	for (int column = line.indexOf('{'); column != -1; column = line.indexOf('{', column + 1))
+	{
+		int container = _structureIndex.containerStartingAt(unformattedPosition(block.position() + column));
+		if (container != -1)
+		{
+			return container;
+		}
+	}
+	return -1;
+}
+
 int JsonEditor::formattedPosition(int position)
 {
-	return cursorPositionHelper(position, text(), _formattedText);
+	return _positionMap.toFormatted(_keySorter.toSorted(position), formatSource(), _formattedText);
 }
 
 int JsonEditor::unformattedPosition(int position)
 {
-	return cursorPositionHelper(position, _formattedText, text());
+	return _keySorter.fromSorted(_positionMap.toUnformatted(position, formatSource(), _formattedText));
 }
 
-int JsonEditor::cursorPositionHelper(int position, QString before, QString after)
+const QString &JsonEditor::formatSource() const
 {
-	int currentPosition = 0;
+	return _formatStyle.sortKeys ? _sortedText : _structureIndex.text();
+}
 
-	// Some quick trivial checks...
-	if (before.length() <= position)
+QVector<int> JsonEditor::formatSourceRootStarts() const
+{
+	QVector<int> starts;
+	starts.reserve(_structureIndex.rootCount());
+	for (int i = 0; i < _structureIndex.rootCount(); i++)
 	{
-		return after.length();
-	}
-	if (position == 0)
-	{
-		return 0;
+		starts.append(_keySorter.toSorted(_structureIndex.member(-1, i).valueStart));
 	}
+	return starts;
+}
 
-	// Loop through both strings...
-	while (currentPosition < position)
+QVector<int> JsonEditor::formatSourceExpandedStrings() const
+{
+	QVector<int> offsets;
+	offsets.reserve(_expandedStrings.count());
+	for (int i = 0; i < _expandedStrings.count(); i++)
 	{
-		if (before.at(currentPosition) != after.at(currentPosition))
-		{
-			int startPosition = currentPosition;
-			if (before.at(startPosition) == HIDDEN_CHAR)
-			{
-				int bracketLevel = 0;
-				before.remove(startPosition, 1);
-				position--;
-				while (before.at(startPosition) != HIDDEN_CHAR && bracketLevel == 0)
-				{
-					if (before.at(startPosition) == '{')
-					{
-						bracketLevel++;
-					}
-					else if (before.at(startPosition) == '}')
-					{
-						bracketLevel--;
-					}
-
-					before.remove(startPosition, 1);
-					if (position > currentPosition)
-					{
-						position--;
-					}
-				}
-				before.remove(startPosition, 1);
-				position--;
-			}
-
-			if (before.mid(startPosition, 3) == ELLIPSES)
-			{
-				before.remove(startPosition, 3);
-				position -= 3;
-			}
-
-			if (after.at(currentPosition) == HIDDEN_CHAR)
-			{
-				int bracketLevel = 0;
-				before.insert(currentPosition, after.at(currentPosition));
-				position++;
-				while (after.at(++currentPosition) != HIDDEN_CHAR && bracketLevel == 0)
-				{
-					if (after.at(currentPosition) == '{')
-					{
-						bracketLevel++;
-					}
-					else if (after.at(currentPosition) == '}')
-					{
-						bracketLevel--;
-					}
-					before.insert(currentPosition, after.at(currentPosition));
-					position++;
-				}
-				before.insert(currentPosition, after.at(currentPosition));
-				position++;
-			}
-
-			if (after.mid(currentPosition, 3) == ELLIPSES)
-			{
-				before.insert(currentPosition, ELLIPSES);
-				position += 3;
-			}
-
-			if (before.at(currentPosition).isSpace())
-			{
-				before.remove(currentPosition, 1);
-				position--;
-				currentPosition--;
-			}
-
-			if (after.at(startPosition).isSpace())
-			{
-				before.insert(startPosition, after.at(startPosition));
-				position++;
-			}
-		}
-		currentPosition++;
+		offsets.append(_keySorter.toSorted(_structureIndex.offsetIncludingMarkers(_expandedStrings.at(i))));
 	}
-	return position;
+
+	// Sorting keys can change the order.
+	std::sort(offsets.begin(), offsets.end());
+	return offsets;
 }
 
-#define INDENT (QString("\t").repeated(indent))
-QString JsonEditor::formattedText(QString text)
+bool JsonEditor::expandStringAt(int position)
 {
-	u_int64_t timeStart = QDateTime::currentMSecsSinceEpoch();
-
-	int indent = 0;
-	QString formatted;
+	if (_formatStyle.maxStringLength <= 0)
+	{
+		return false;
+	}
 
-	text = text.trimmed();
-	bool insideQuotes = false;
-	bool insideArray = false;
-	int hidden = 0;
+	// The shown start of a string is at most twice the limit, when it is all escape sequences.
+	QVector<JsonPositionMap::Truncation> truncations = _positionMap.truncations(position, position + 2 * _formatStyle.maxStringLength + 2);
+	if (truncations.isEmpty() || position > truncations.first().formattedEnd)
+	{
+		return false;
+	}
 
-	// First split by quotation marks. (But not by quotation marks preceded by a backslash)
-	foreach (QString const &item, text.split(QRegularExpression(R"((?<!\\)\")")))
+	// Walk back from the cut to the opening quote, the first one that isn't escaped.
+	const JsonPositionMap::Truncation &truncation = truncations.first();
+	const QString &source = formatSource();
+	int quote = truncation.unformattedStart - 1;
+	for (; quote > 0; quote--)
 	{
-		if (insideQuotes)
+		if (source.at(quote) != '"')
 		{
-			if (!hidden)
-			{
-				if (formatted.endsWith("\n"))
-				{
-					formatted += INDENT;
-				}
-				formatted += "\"";
-				formatted += item;
-				formatted += "\"";
-			}
+			continue;
 		}
-		else
+		int backslashes = 0;
+		while (quote - backslashes > 0 && source.at(quote - backslashes - 1) == '\\')
 		{
-			QString cleaned = item.trimmed();
-
-			while (!cleaned.isEmpty())
-			{
-				if (cleaned.startsWith(':'))
-				{
-					if (!hidden)
-					{
-						formatted += ": ";
-					}
-					cleaned.remove(0, 1);
-					cleaned = cleaned.trimmed();
-				}
-				else if (cleaned.startsWith(","))
-				{
-					if (!hidden)
-					{
-						formatted += ",";
-						if (insideArray)
-						{
-							formatted += " ";
-						}
-						else
-						{
-							formatted += "\n";
-						}
-					}
-					cleaned.remove(0, 1);
-					cleaned = cleaned.trimmed();
-				}
-				else if (cleaned.startsWith('{') || cleaned.startsWith('['))
-				{
-					if (!hidden)
-					{
-						if (formatted.endsWith("\n"))
-						{
-							formatted += INDENT;
-						}
-
-						formatted += cleaned.at(0);
-						if (cleaned.startsWith('['))
-						{
-							insideArray = true;
-							formatted += " ";
-						}
-						else
-						{
-							formatted += "\n";
-						}
-					}
-					cleaned.remove(0, 1);
-					if (cleaned.startsWith(HIDDEN_CHAR))
-					{
-						cleaned.remove(0, 1);
-
-						if (!hidden)
-						{
-							// Remove the newline at the end and replace with an ellipses.
-							formatted.chop(1);
-							formatted += " " ELLIPSES " ";
-						}
-						hidden++;
-					}
-					else
-					{
-						cleaned = cleaned.trimmed();
-						indent++;
-					}
-				}
-				else if (cleaned.startsWith('}') || cleaned.startsWith(']'))
-				{
-					indent--;
-					if (!hidden)
-					{
-						if (!insideArray)
-						{
-							formatted += "\n";
-							formatted += INDENT;
-						}
-						else
-						{
-							formatted += " ";
-						}
-						formatted += cleaned.at(0);
-					}
-					if (cleaned.startsWith(']'))
-					{
-						insideArray = false;
-					}
-					cleaned.remove(0, 1);
-					cleaned = cleaned.trimmed();
-				}
-				else
-				{
-					if (cleaned.startsWith(HIDDEN_CHAR))
-					{
-						hidden--;
-						cleaned.remove(0, 1);
-					}
-					if (!hidden)
-					{
-						if (formatted.endsWith("\n"))
-						{
-							formatted += INDENT;
-						}
-						if (!cleaned.isEmpty())
-						{
-							formatted += cleaned.at(0);
-						}
-					}
-
-					cleaned.remove(0, 1);
-					cleaned = cleaned.trimmed();
-				}
-			}
+			backslashes++;
+		}
+		if (backslashes % 2 == 0)
+		{
+			break;
 		}
-		insideQuotes = !insideQuotes;
+	}
+	if (position < truncation.formattedStart - (truncation.unformattedStart - quote))
+	{
+		return false;
 	}
 
-	// If we erroneously put an ending quotation mark, remove it.
-	if (!text.endsWith("\"") && formatted.endsWith("\""))
+	int rawQuote = _keySorter.fromSorted(quote);
+	int offset = rawQuote - _structureIndex.markersBefore(rawQuote);
+	QVector<int>::iterator it = std::lower_bound(_expandedStrings.begin(), _expandedStrings.end(), offset);
+	if (it == _expandedStrings.end() || *it != offset)
 	{
-		formatted.chop(1);
+		_expandedStrings.insert(it, offset);
 	}
+	return true;
+}
 
-	qDebug("time to format text: %llu ms", QDateTime::currentMSecsSinceEpoch() - timeStart);
-	return formatted;
+void JsonEditor::shiftExpandedStrings(int position, int charsRemoved, int charsAdded)
+{
+	// Strings whose opening quote was removed are gone; the rest move with the text after the edit.
+	for (int i = _expandedStrings.count() - 1; i >= 0; i--)
+	{
+		int offset = _expandedStrings.at(i);
+		if (offset >= position + charsRemoved)
+		{
+			_expandedStrings[i] = offset + charsAdded - charsRemoved;
+		}
+		else if (offset >= position)
+		{
+			_expandedStrings.remove(i);
+		}
+	}
+}
+
+QString JsonEditor::formattedText(const QString &text, const JsonFormatStyle &style)
+{
+	return JsonFormatter::format(text, style);
 }
 
 int JsonEditor::positionOverLine(QPoint position)
@@ -9,6 +9,12 @@
 #define JSONEDITOR_H
 
 #include <QPlainTextEdit>
+#include <QBitArray>
+#include "jsonstructureindex.h"
+#include "jsonpositionmap.h"
+#include "jsonformatter.h"
+#include "jsonkeysorter.h"
+#include "jsonmemoryusage.h"
 
 class JsonMarginWidget;
 class JsonEditor : public QPlainTextEdit
@@ -17,38 +23,104 @@ class JsonEditor : public QPlainTextEdit
 	friend class JsonMarginWidget;
 
 public:
+	/// What a document gives up, in order, once it takes more memory than its cap.
+	enum DegradeLevel
+	{
+		FullView,
+		WithoutUndo,			///< Undo history is dropped and no longer kept.
+		WithoutFormatting		///< The raw text is shown instead of the formatted view.
+	};
+
 	explicit JsonEditor(QWidget *parent = nullptr);
 	virtual ~JsonEditor();
 
 	void setText(const QString &text);
+	void setIndexedText(const JsonStructureIndex &index, const QBitArray &folds = QBitArray());
+	void appendText(const QString &text);
 	QString text();
 
-	static QString formattedText(QString text);
+	const JsonStructureIndex &structureIndex() const;
+	QBitArray foldedContainers() const;
+	int rawCursorPosition();
+	int firstVisibleRawPosition();
+	void scrollToRawPosition(int position);
+
+	const JsonFormatStyle &formatStyle() const;
+	void setFormatStyle(const JsonFormatStyle &style);
+	bool isFormatted() const;
+
+	qint64 derivedDataSize() const;
+	bool isDerivedDataReleased() const;
+	void releaseDerivedData();
+	void restoreDerivedData();
+
+	JsonMemoryUsage memoryUsage() const;
+	DegradeLevel degradeLevel() const;
+	void setMemoryCap(qint64 bytes);
+
+	static QString formattedText(const QString &text, const JsonFormatStyle &style = JsonFormatStyle());
 
 public slots:
 	void setFormatted(bool);
+	void setRawCursorPosition(int position);
+
+	void foldAll();
+	void unfoldAll();
+	void foldToDepth(int depth);
 
 protected:
 	void keyPressEvent(QKeyEvent *e);
+	void mouseDoubleClickEvent(QMouseEvent *e);
 	void paintEvent(QPaintEvent *e);
+	QMimeData *createMimeDataFromSelection() const;
 
 	bool eventFilter(QObject *, QEvent *);
 
 signals:
 	void documentFormatted(bool);
+	void structureIndexChanged();
+	void rawCursorPositionChanged(int);
+	void rawTextEdited(int position, int charsRemoved, const QString &charsAdded);
+	void degraded(JsonEditor::DegradeLevel level);
 
 private slots:
 	void updateText();
+	void updateRawCursorPosition();
+	void rawContentsChanged(int position, int charsRemoved, int charsAdded);
+	void visibleContentsChanged(int position, int charsRemoved, int charsAdded);
 	void paintMarginWidget(QPaintEvent *e);
+	void enforceMemoryCap();
 
 private:
 	int formattedPosition(int position);
 	int unformattedPosition(int position);
-	int cursorPositionHelper(int pos, QString before, QString after);
+	const QString &formatSource() const;
+	QVector<int> formatSourceRootStarts() const;
+	QVector<int> formatSourceExpandedStrings() const;
+	bool expandStringAt(int position);
+	void shiftExpandedStrings(int position, int charsRemoved, int charsAdded);
+	void updateFormatting(bool formatted);
+	void applyFolds(const QBitArray &folds);
 	int positionOverLine(QPoint position);
+	int containerOnLine(const QTextBlock &block);
+	void setUndoHistoryEnabled(bool enabled);
+	void createUnformattedTextEdit();
+	void reportRawEdit(QTextDocument *document, int position, int charsRemoved, int charsAdded);
 
 	bool _formatDocument;
+	bool _replacingText;
+	bool _derivedDataReleased;
+	int _releasedCursorPosition;
+	int _releasedScrollPosition;
+	qint64 _memoryCap;					///< Bytes the document may take before it degrades, or 0 for no limit.
+	DegradeLevel _degradeLevel;
+	JsonFormatStyle _formatStyle;
 	QString _formattedText;
+	QString _sortedText;
+	JsonKeySorter _keySorter;
+	JsonStructureIndex _structureIndex;
+	JsonPositionMap _positionMap;
+	QVector<int> _expandedStrings;		///< Opening quotes of strings shown in full, as offsets without fold markers.
 	QPlainTextEdit *_unformattedTextEdit;
 	JsonMarginWidget *_marginWidget;
 };
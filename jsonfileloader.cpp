@@ -0,0 +1,56 @@
+/**
+ * @file jsonfileloader.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsonfileloader.h"
+#include "jsontranscoder.h"
+
+JsonFileLoader::JsonFileLoader(const QStringList &fileNames, QObject *parent) :
+	QThread(parent),
+	_fileNames(fileNames),
+	_loaded(0)
+{
+	foreach (const QString &fileName, fileNames)
+	{
+		if (JsonTranscoder::formatForFile(fileName) == JsonTranscoder::Json)
+		{
+			JsonDocumentTab::Contents file;
+			file.fileName = fileName;
+			file.size = 0;
+			file.loaded = false;
+			_contents.append(file);
+		}
+	}
+}
+
+JsonFileLoader::~JsonFileLoader()
+{
+	wait();
+}
+
+QStringList JsonFileLoader::fileNames() const
+{
+	return _fileNames;
+}
+
+QVector<JsonDocumentTab::Contents> &JsonFileLoader::contents()
+{
+	return _contents;
+}
+
+bool JsonFileLoader::isLoaded() const
+{
+	return _loaded.load() != 0;
+}
+
+void JsonFileLoader::run()
+{
+	JsonDocumentTab::loadAll(_contents);
+
+	// Set before the signal, so whoever connects to it late can still tell it was missed.
+	_loaded.store(1);
+	emit loaded();
+}
@@ -0,0 +1,40 @@
+/**
+ * @file jsonfileloader.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Reads and indexes JSON files in the background while the window is being built.
+ */
+#ifndef JSONFILELOADER_H
+#define JSONFILELOADER_H
+
+#include <QThread>
+#include <QStringList>
+#include <QAtomicInt>
+#include "jsondocumenttab.h"
+
+class JsonFileLoader : public QThread
+{
+	Q_OBJECT
+
+public:
+	explicit JsonFileLoader(const QStringList &fileNames, QObject *parent = nullptr);
+	virtual ~JsonFileLoader();
+
+	QStringList fileNames() const;
+	QVector<JsonDocumentTab::Contents> &contents();
+	bool isLoaded() const;
+
+signals:
+	void loaded();
+
+protected:
+	virtual void run();
+
+private:
+	QStringList _fileNames;
+	QVector<JsonDocumentTab::Contents> _contents;	///< Only the JSON text files; the others are decoded once they are opened.
+	QAtomicInt _loaded;
+};
+
+#endif // JSONFILELOADER_H
@@ -0,0 +1,781 @@
+/**
+ * @file jsonformatter.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsonformatter.h"
+#include "jsonstructureindex.h"
+#include "jsonworkerpool.h"
+#include <QVector>
+#include <QSettings>
+#include <QDateTime>
+#include <climits>
+#include <algorithm>
+
+#ifdef JSONPAD_FORMATTER_BENCHMARK
+#include <QRegularExpression>
+#endif
+
+#define DEFAULT_INDENT_WIDTH			4
+#define DEFAULT_INLINE_ARRAY_WIDTH		80
+
+// Whitespace in the source can make a short container arbitrarily long, so measuring
+// one gives up after this many source characters per character of allowed width.
+#define MEASURE_SOURCE_FACTOR			8
+
+// Texts shorter than this are formatted on the calling thread.
+#define PARALLEL_FORMAT_MIN_LENGTH			(4 * 1024 * 1024)
+#define PARALLEL_FORMAT_MIN_CHUNK			(256 * 1024)
+#define PARALLEL_FORMAT_CHUNKS_PER_THREAD	4
+
+static inline bool isWhitespace(QChar c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool isDelimiter(QChar c)
+{
+	switch (c.unicode())
+	{
+		case ' ': case '\t': case '\n': case '\r':
+		case ',': case ':': case '"':
+		case '{': case '}': case '[': case ']':
+		case HIDDEN_CHAR:
+			return true;
+		default:
+			return false;
+	}
+}
+
+JsonFormatStyle::JsonFormatStyle() :
+	indentWithTabs(true),
+	indentWidth(DEFAULT_INDENT_WIDTH),
+	arrayStyle(InlineArrays),
+	inlineArrayWidth(DEFAULT_INLINE_ARRAY_WIDTH),
+	compactObjectWidth(0),
+	sortKeys(false),
+	maxStringLength(0)
+{
+}
+
+JsonFormatStyle JsonFormatStyle::load()
+{
+	JsonFormatStyle style;
+	QSettings settings;
+	settings.beginGroup("format");
+	style.indentWithTabs = settings.value("indentWithTabs", style.indentWithTabs).toBool();
+	style.indentWidth = qBound(1, settings.value("indentWidth", style.indentWidth).toInt(), 16);
+	style.arrayStyle = ArrayStyle(qBound(int(InlineArrays), settings.value("arrayStyle", int(style.arrayStyle)).toInt(), int(InlineArraysUpToWidth)));
+	style.inlineArrayWidth = qMax(1, settings.value("inlineArrayWidth", style.inlineArrayWidth).toInt());
+	style.compactObjectWidth = qMax(0, settings.value("compactObjectWidth", style.compactObjectWidth).toInt());
+	style.sortKeys = settings.value("sortKeys", style.sortKeys).toBool();
+	style.maxStringLength = qMax(0, settings.value("maxStringLength", style.maxStringLength).toInt());
+	settings.endGroup();
+	return style;
+}
+
+void JsonFormatStyle::save() const
+{
+	QSettings settings;
+	settings.beginGroup("format");
+	settings.setValue("indentWithTabs", indentWithTabs);
+	settings.setValue("indentWidth", indentWidth);
+	settings.setValue("arrayStyle", int(arrayStyle));
+	settings.setValue("inlineArrayWidth", inlineArrayWidth);
+	settings.setValue("compactObjectWidth", compactObjectWidth);
+	settings.setValue("sortKeys", sortKeys);
+	settings.setValue("maxStringLength", maxStringLength);
+	settings.endGroup();
+}
+
+bool JsonFormatStyle::operator==(const JsonFormatStyle &other) const
+{
+	return indentWithTabs == other.indentWithTabs &&
+		   indentWidth == other.indentWidth &&
+		   arrayStyle == other.arrayStyle &&
+		   inlineArrayWidth == other.inlineArrayWidth &&
+		   compactObjectWidth == other.compactObjectWidth &&
+		   sortKeys == other.sortKeys &&
+		   maxStringLength == other.maxStringLength;
+}
+
+bool JsonFormatStyle::operator!=(const JsonFormatStyle &other) const
+{
+	return !(*this == other);
+}
+
+#ifdef JSONPAD_FORMATTER_BENCHMARK
+#define INDENT (QString("\t").repeated(indent))
+
+// The formatter the specialized one replaced, kept as it was so the two can be timed against each other.
+static QString baselineFormat(QString text)
+{
+	int indent = 0;
+	QString formatted;
+
+	text = text.trimmed();
+	bool insideQuotes = false;
+	bool insideArray = false;
+	int hidden = 0;
+
+	// First split by quotation marks. (But not by quotation marks preceded by a backslash)
+	foreach (QString const &item, text.split(QRegularExpression(R"((?<!\\)\")")))
+	{
+		if (insideQuotes)
+		{
+			if (!hidden)
+			{
+				if (formatted.endsWith("\n"))
+				{
+					formatted += INDENT;
+				}
+				formatted += "\"";
+				formatted += item;
+				formatted += "\"";
+			}
+		}
+		else
+		{
+			QString cleaned = item.trimmed();
+
+			while (!cleaned.isEmpty())
+			{
+				if (cleaned.startsWith(':'))
+				{
+					if (!hidden)
+					{
+						formatted += ": ";
+					}
+					cleaned.remove(0, 1);
+					cleaned = cleaned.trimmed();
+				}
+				else if (cleaned.startsWith(","))
+				{
+					if (!hidden)
+					{
+						formatted += ",";
+						if (insideArray)
+						{
+							formatted += " ";
+						}
+						else
+						{
+							formatted += "\n";
+						}
+					}
+					cleaned.remove(0, 1);
+					cleaned = cleaned.trimmed();
+				}
+				else if (cleaned.startsWith('{') || cleaned.startsWith('['))
+				{
+					if (!hidden)
+					{
+						if (formatted.endsWith("\n"))
+						{
+							formatted += INDENT;
+						}
+
+						formatted += cleaned.at(0);
+						if (cleaned.startsWith('['))
+						{
+							insideArray = true;
+							formatted += " ";
+						}
+						else
+						{
+							formatted += "\n";
+						}
+					}
+					cleaned.remove(0, 1);
+					if (cleaned.startsWith(HIDDEN_CHAR))
+					{
+						cleaned.remove(0, 1);
+
+						if (!hidden)
+						{
+							// Remove the newline at the end and replace with an ellipses.
+							formatted.chop(1);
+							formatted += " " ELLIPSES " ";
+						}
+						hidden++;
+					}
+					else
+					{
+						cleaned = cleaned.trimmed();
+						indent++;
+					}
+				}
+				else if (cleaned.startsWith('}') || cleaned.startsWith(']'))
+				{
+					indent--;
+					if (!hidden)
+					{
+						if (!insideArray)
+						{
+							formatted += "\n";
+							formatted += INDENT;
+						}
+						else
+						{
+							formatted += " ";
+						}
+						formatted += cleaned.at(0);
+					}
+					if (cleaned.startsWith(']'))
+					{
+						insideArray = false;
+					}
+					cleaned.remove(0, 1);
+					cleaned = cleaned.trimmed();
+				}
+				else
+				{
+					if (cleaned.startsWith(HIDDEN_CHAR))
+					{
+						hidden--;
+						cleaned.remove(0, 1);
+					}
+					if (!hidden)
+					{
+						if (formatted.endsWith("\n"))
+						{
+							formatted += INDENT;
+						}
+						if (!cleaned.isEmpty())
+						{
+							formatted += cleaned.at(0);
+						}
+					}
+
+					cleaned.remove(0, 1);
+					cleaned = cleaned.trimmed();
+				}
+			}
+		}
+		insideQuotes = !insideQuotes;
+	}
+
+	// If we erroneously put an ending quotation mark, remove it.
+	if (!text.endsWith("\"") && formatted.endsWith("\""))
+	{
+		formatted.chop(1);
+	}
+
+	return formatted;
+}
+
+#undef INDENT
+#endif
+
+QString JsonFormatter::format(const QString &text, const JsonFormatStyle &style)
+{
+	qint64 timeStart = QDateTime::currentMSecsSinceEpoch();
+
+	Source source = { text.constData(), text.length(), 0, NULL };
+	QString formatted;
+	formatRange(source, style, formatted);
+
+	qDebug("time to format text: %lld ms (%d characters)", QDateTime::currentMSecsSinceEpoch() - timeStart, text.length());
+	return formatted;
+}
+
+QString JsonFormatter::format(const QString &text, const JsonFormatStyle &style, const QVector<int> &rootStarts,
+							  const QVector<int> &expandedStrings)
+{
+	qint64 timeStart = QDateTime::currentMSecsSinceEpoch();
+
+	int workers = JsonWorkerPool::instance().workerCount() + 1;
+	if (text.length() < PARALLEL_FORMAT_MIN_LENGTH || rootStarts.count() < 2 || workers < 2)
+	{
+		Source source = { text.constData(), text.length(), 0, &expandedStrings };
+		QString formatted;
+		formatRange(source, style, formatted);
+
+		qDebug("time to format text: %lld ms (%d characters)", QDateTime::currentMSecsSinceEpoch() - timeStart, text.length());
+		return formatted;
+	}
+
+	// Each top-level value is formatted without regard to the ones before it, so the text can
+	// be cut at the start of any of them.  There are a few chunks per thread so that a long
+	// value doesn't leave the other threads idle.
+	int chunkLength = qMax(PARALLEL_FORMAT_MIN_CHUNK, text.length() / (workers * PARALLEL_FORMAT_CHUNKS_PER_THREAD));
+	QVector<int> cuts;
+	cuts.append(0);
+	for (int i = 0; i < rootStarts.count(); i++)
+	{
+		if (rootStarts.at(i) - cuts.last() >= chunkLength)
+		{
+			cuts.append(rootStarts.at(i));
+		}
+	}
+	cuts.append(text.length());
+
+	// Tasks write through a pointer taken beforehand, as calling the non-const operator[] from several threads isn't safe.
+	QVector<QString> chunks(cuts.count() - 1);
+	QString *results = chunks.data();
+	QVector<JsonWorkerPool::Task> tasks;
+	for (int i = 0; i < chunks.count(); i++)
+	{
+		tasks.append([&text, &style, &expandedStrings, &cuts, results, i]()
+		{
+			Source source = { text.constData() + cuts.at(i), cuts.at(i + 1) - cuts.at(i), cuts.at(i), &expandedStrings };
+			formatRange(source, style, results[i]);
+		});
+	}
+	JsonWorkerPool::instance().run(tasks);
+
+	// A single pass would have put a line break before every top-level value after the first.
+	int formattedLength = 0;
+	for (int i = 0; i < chunks.count(); i++)
+	{
+		formattedLength += chunks.at(i).length() + 1;
+	}
+
+	QString formatted;
+	formatted.reserve(formattedLength);
+	for (int i = 0; i < chunks.count(); i++)
+	{
+		if (chunks.at(i).isEmpty())
+		{
+			continue;
+		}
+		if (!formatted.isEmpty())
+		{
+			formatted += '\n';
+		}
+		formatted += chunks.at(i);
+		chunks[i].clear();
+	}
+
+	qDebug("time to format text: %lld ms (%d characters in %d chunks)", QDateTime::currentMSecsSinceEpoch() - timeStart, text.length(), chunks.count());
+	return formatted;
+}
+
+void JsonFormatter::formatRange(const Source &source, const JsonFormatStyle &style, QString &formatted)
+{
+	formatted.reserve(source.length + source.length / 2);
+
+	if (style.indentWithTabs)
+	{
+		formatWithIndent<true>(source, style, formatted);
+	}
+	else
+	{
+		formatWithIndent<false>(source, style, formatted);
+	}
+
+	// Shortened strings can leave most of the reserved space unused.
+	if (style.maxStringLength > 0)
+	{
+		formatted.squeeze();
+	}
+}
+
+template <bool IndentWithTabs>
+void JsonFormatter::formatWithIndent(const Source &source, const JsonFormatStyle &style, QString &formatted)
+{
+	switch (style.arrayStyle)
+	{
+		case JsonFormatStyle::InlineArrays:
+			formatWithArrays<IndentWithTabs, JsonFormatStyle::InlineArrays>(source, style, formatted);
+			break;
+		case JsonFormatStyle::ExpandedArrays:
+			formatWithArrays<IndentWithTabs, JsonFormatStyle::ExpandedArrays>(source, style, formatted);
+			break;
+		case JsonFormatStyle::InlineArraysUpToWidth:
+			formatWithArrays<IndentWithTabs, JsonFormatStyle::InlineArraysUpToWidth>(source, style, formatted);
+			break;
+	}
+}
+
+template <bool IndentWithTabs, JsonFormatStyle::ArrayStyle Arrays>
+void JsonFormatter::formatWithArrays(const Source &source, const JsonFormatStyle &style, QString &formatted)
+{
+	if (style.compactObjectWidth > 0)
+	{
+		format<IndentWithTabs, Arrays, true>(source, style, formatted);
+	}
+	else
+	{
+		format<IndentWithTabs, Arrays, false>(source, style, formatted);
+	}
+}
+
+template <bool IndentWithTabs, JsonFormatStyle::ArrayStyle Arrays, bool CompactObjects>
+void JsonFormatter::format(const Source &source, const JsonFormatStyle &style, QString &formatted)
+{
+	const QChar *data = source.data;
+	const int length = source.length;
+
+	const QString unit = IndentWithTabs ? QString("\t") : QString(style.indentWidth, ' ');
+	QString indentation;
+
+	// One entry per open container, set if the container is kept on a single line.
+	QVector<bool> inlined;
+
+	// Containers measured to fit on a line keep everything inside them on that line too.
+	int forcedFrom = INT_MAX;
+	bool rootEnded = false;
+
+	auto newLine = [&](int depth)
+	{
+		int needed = IndentWithTabs ? depth : depth * unit.length();
+		while (indentation.length() < needed)
+		{
+			indentation += unit;
+		}
+		formatted += '\n';
+		formatted.append(indentation.constData(), needed);
+	};
+
+	for (int i = 0; i < length; i++)
+	{
+		QChar c = data[i];
+		switch (c.unicode())
+		{
+			case ' ': case '\t': case '\n': case '\r':
+				break;
+
+			case ':':
+				formatted += ": ";
+				break;
+
+			case ',':
+				if (inlined.isEmpty() || inlined.last())
+				{
+					formatted += ", ";
+				}
+				else
+				{
+					formatted += ',';
+					newLine(inlined.count());
+				}
+				break;
+
+			case HIDDEN_CHAR:
+				// A stray closing marker with no fold open is dropped, so it can't hide the rest of the document.
+				break;
+
+			case '"':
+			{
+				if (inlined.isEmpty() && rootEnded)
+				{
+					formatted += '\n';
+				}
+				int end = stringEnd(data, i, length);
+				if (style.maxStringLength > 0 && end - i - 1 > style.maxStringLength)
+				{
+					appendTruncatedString(source, i, end, style.maxStringLength, formatted);
+				}
+				else
+				{
+					formatted.append(data + i, end - i + 1);
+				}
+				i = end;
+				rootEnded = inlined.isEmpty();
+				break;
+		}
+
+		case '{': case '[':
+		{
+			if (inlined.isEmpty() && rootEnded)
+			{
+				formatted += '\n';
+			}
+
+			QChar close = c == '{' ? QChar('}') : QChar(']');
+			int next = skipWhitespace(data, i + 1, length);
+
+			// Folded containers collapse to an ellipses.
+			if (next < length && data[next] == HIDDEN_CHAR)
+			{
+				int end = skipWhitespace(data, hiddenSectionEnd(data, next, length), length);
+				formatted += c;
+				formatted += " " ELLIPSES " ";
+				if (end < length && (data[end] == '}' || data[end] == ']'))
+				{
+					formatted += data[end];
+					i = end;
+				}
+				else
+				{
+					i = end - 1;
+				}
+				rootEnded = inlined.isEmpty();
+				break;
+			}
+
+			if (next < length && data[next] == close)
+			{
+				formatted += c;
+				formatted += close;
+				i = next;
+				rootEnded = inlined.isEmpty();
+				break;
+			}
+
+			bool keepInline;
+			bool measured = false;
+			if (inlined.count() > forcedFrom)
+			{
+				keepInline = true;
+			}
+			else if (c == '[')
+			{
+				if (Arrays == JsonFormatStyle::InlineArraysUpToWidth)
+				{
+					keepInline = fitsOnLine(data, i, length, style.inlineArrayWidth);
+					measured = true;
+				}
+				else
+				{
+					keepInline = Arrays == JsonFormatStyle::InlineArrays;
+				}
+			}
+			else if (CompactObjects)
+			{
+				keepInline = fitsOnLine(data, i, length, style.compactObjectWidth);
+				measured = true;
+			}
+			else
+			{
+				keepInline = false;
+			}
+
+			if (measured && keepInline)
+			{
+				forcedFrom = inlined.count();
+			}
+			inlined.append(keepInline);
+
+			formatted += c;
+			if (keepInline)
+			{
+				formatted += ' ';
+			}
+			else
+			{
+				newLine(inlined.count());
+			}
+			break;
+		}
+
+		case '}': case ']':
+		{
+			if (inlined.isEmpty())
+			{
+				formatted += c;
+				rootEnded = true;
+				break;
+			}
+
+			bool keepInline = inlined.takeLast();
+			if (inlined.count() == forcedFrom)
+			{
+				forcedFrom = INT_MAX;
+			}
+
+			if (keepInline)
+			{
+				formatted += ' ';
+			}
+			else
+			{
+				newLine(inlined.count());
+			}
+			formatted += c;
+			rootEnded = inlined.isEmpty();
+			break;
+		}
+
+		default:
+		{
+			if (inlined.isEmpty() && rootEnded)
+			{
+				formatted += '\n';
+			}
+			int end = i + 1;
+			while (end < length && !isDelimiter(data[end]))
+			{
+				end++;
+			}
+			formatted.append(data + i, end - i);
+			i = end - 1;
+			rootEnded = inlined.isEmpty();
+			break;
+		}
+		}
+	}
+}
+
+int JsonFormatter::skipWhitespace(const QChar *data, int position, int length)
+{
+	while (position < length && isWhitespace(data[position]))
+	{
+		position++;
+	}
+	return position;
+}
+
+int JsonFormatter::stringEnd(const QChar *data, int position, int length)
+{
+	for (int i = position + 1; i < length; i++)
+	{
+		if (data[i] == '\\')
+		{
+			i++;
+		}
+		else if (data[i] == '"')
+		{
+			return i;
+		}
+	}
+	return length - 1;
+}
+
+int JsonFormatter::hiddenSectionEnd(const QChar *data, int position, int length)
+{
+	int depth = 0;
+	for (int i = position; i < length; i++)
+	{
+		if (data[i] != HIDDEN_CHAR)
+		{
+			continue;
+		}
+
+		// A closing marker sits directly before the closing brace; any other marker opens a nested section.
+		int next = skipWhitespace(data, i + 1, length);
+		if (next < length && (data[next] == '}' || data[next] == ']'))
+		{
+			if (--depth == 0)
+			{
+				return i + 1;
+			}
+		}
+		else
+		{
+			depth++;
+		}
+	}
+	return length;
+}
+
+bool JsonFormatter::fitsOnLine(const QChar *data, int position, int length, int width)
+{
+	int limit = qMin(length, position + width * MEASURE_SOURCE_FACTOR);
+	int rendered = 0;
+	int depth = 0;
+
+	for (int i = position; i < limit && rendered <= width; i++)
+	{
+		switch (data[i].unicode())
+		{
+			case ' ': case '\t': case '\n': case '\r':
+				break;
+			case HIDDEN_CHAR:
+				return false;
+			case '"':
+			{
+				int end = stringEnd(data, i, length);
+				rendered += end - i + 1;
+				i = end;
+				break;
+		}
+		case '{': case '[':
+			depth++;
+			rendered += 2;
+			break;
+		case '}': case ']':
+			rendered += 2;
+			if (--depth == 0)
+			{
+				return rendered <= width;
+			}
+			break;
+		case ',': case ':':
+			rendered += 2;
+			break;
+		default:
+			rendered++;
+			break;
+		}
+	}
+	return false;
+}
+
+int JsonFormatter::truncationPoint(const QChar *data, int position, int end, int length)
+{
+	// Escape sequences count as one character and are never split; \uXXXX is six characters long.
+	int cut = position + 1;
+	for (int shown = 0; shown < length && cut < end; shown++)
+	{
+		if (data[cut] != '\\')
+		{
+			cut++;
+		}
+		else
+		{
+			cut += cut + 1 < end && data[cut + 1] == 'u' ? 6 : 2;
+		}
+	}
+	cut = qMin(cut, end);
+
+	// Nor are surrogate pairs, and the hidden part can't start with the character that starts ELLIPSES.
+	while (cut < end && (data[cut].isLowSurrogate() || data[cut] == ELLIPSES_CHAR))
+	{
+		cut++;
+	}
+	return cut;
+}
+
+void JsonFormatter::appendTruncatedString(const Source &source, int position, int end, int maxLength, QString &formatted)
+{
+	const QChar *data = source.data;
+	if (source.expandedStrings != NULL &&
+		std::binary_search(source.expandedStrings->constBegin(), source.expandedStrings->constEnd(), source.offset + position))
+	{
+		formatted.append(data + position, end - position + 1);
+		return;
+	}
+
+	int cut = truncationPoint(data, position, end, maxLength);
+	if (cut >= end)
+	{
+		formatted.append(data + position, end - position + 1);
+		return;
+	}
+
+	// The size is what the string takes up in the file, as UTF-8.
+	qint64 bytes = 0;
+	for (int i = position + 1; i < end; i++)
+	{
+		ushort c = data[i].unicode();
+		bytes += c < 0x80 ? 1 : (c < 0x800 || QChar::isSurrogate(c) ? 2 : 3);
+	}
+
+	formatted.append(data + position, cut - position);
+	formatted += ELLIPSES " (";
+	formatted += QString::number(bytes);
+	formatted += " bytes)\"";
+}
+
+#ifdef JSONPAD_FORMATTER_BENCHMARK
+void JsonFormatter::benchmark(const QString &text)
+{
+	// Both run on the calling thread, and the default style is the one the old formatter produced.
+	qint64 timeStart = QDateTime::currentMSecsSinceEpoch();
+	QString baseline = baselineFormat(text);
+	qint64 baselineTime = QDateTime::currentMSecsSinceEpoch() - timeStart;
+
+	timeStart = QDateTime::currentMSecsSinceEpoch();
+	Source source = { text.constData(), text.length(), 0, NULL };
+	QString specialized;
+	formatRange(source, JsonFormatStyle(), specialized);
+	qint64 specializedTime = QDateTime::currentMSecsSinceEpoch() - timeStart;
+
+	qDebug("time to format %d characters: %lld ms before specializing (%d characters out), %lld ms with the default style (%d characters out)",
+		   text.length(), baselineTime, baseline.length(), specializedTime, specialized.length());
+}
+#endif
@@ -0,0 +1,92 @@
+/**
+ * @file jsonformatter.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Formatting styles and the formatter that applies them.
+ */
+#ifndef JSONFORMATTER_H
+#define JSONFORMATTER_H
+
+#include <QString>
+#include <QVector>
+
+struct JsonFormatStyle
+{
+	enum ArrayStyle
+	{
+		InlineArrays,
+		ExpandedArrays,
+		InlineArraysUpToWidth
+	};
+
+	JsonFormatStyle();
+
+	static JsonFormatStyle load();
+	void save() const;
+
+	bool operator==(const JsonFormatStyle &other) const;
+	bool operator!=(const JsonFormatStyle &other) const;
+
+	bool indentWithTabs;
+	int indentWidth;			///< Width of one indentation level, in spaces.
+	ArrayStyle arrayStyle;
+	int inlineArrayWidth;		///< Widest array kept on one line with InlineArraysUpToWidth.
+	int compactObjectWidth;		///< Widest object kept on one line, or 0 to always expand objects.
+	bool sortKeys;
+	int maxStringLength;		///< Longest string shown in full, or 0 to always show strings in full.
+};
+
+/**
+ * Formats JSON text in a single pass.  The loop is a template over the style options, so
+ * each combination is compiled separately and the common styles don't test any options
+ * while copying characters.
+ *
+ * Large texts holding several top-level values can be formatted in chunks on the worker
+ * pool instead, given the offsets where those values start.
+ *
+ * Strings longer than the style allows are cut short and end in ELLIPSES followed by
+ * their full size, unless they are listed as expanded.  Only the display is shortened;
+ * the cut never falls inside an escape sequence, a surrogate pair or on a character
+ * that starts ELLIPSES, so the position map can tell where the hidden part begins.
+ */
+class JsonFormatter
+{
+public:
+	static QString format(const QString &text, const JsonFormatStyle &style);
+	static QString format(const QString &text, const JsonFormatStyle &style, const QVector<int> &rootStarts,
+						  const QVector<int> &expandedStrings = QVector<int>());
+
+#ifdef JSONPAD_FORMATTER_BENCHMARK
+	static void benchmark(const QString &text);
+#endif
+
+private:
+	struct Source
+	{
+		const QChar *data;
+		int length;
+		int offset;								///< Offset of data within the whole text.
+		const QVector<int> *expandedStrings;	///< Offsets of strings never shortened, in order.
+	};
+
+	static void formatRange(const Source &source, const JsonFormatStyle &style, QString &formatted);
+
+	template <bool IndentWithTabs, JsonFormatStyle::ArrayStyle Arrays, bool CompactObjects>
+	static void format(const Source &source, const JsonFormatStyle &style, QString &formatted);
+
+	template <bool IndentWithTabs, JsonFormatStyle::ArrayStyle Arrays>
+	static void formatWithArrays(const Source &source, const JsonFormatStyle &style, QString &formatted);
+
+	template <bool IndentWithTabs>
+	static void formatWithIndent(const Source &source, const JsonFormatStyle &style, QString &formatted);
+
+	static int skipWhitespace(const QChar *data, int position, int length);
+	static int stringEnd(const QChar *data, int position, int length);
+	static int hiddenSectionEnd(const QChar *data, int position, int length);
+	static bool fitsOnLine(const QChar *data, int position, int length, int width);
+	static int truncationPoint(const QChar *data, int position, int end, int length);
+	static void appendTruncatedString(const Source &source, int position, int end, int maxLength, QString &formatted);
+};
+
+#endif // JSONFORMATTER_H
@@ -0,0 +1,191 @@
+/**
+ * @file jsonindexcache.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsonindexcache.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+
+#define CACHE_MAGIC				0x4a504943		// "JPIC"
+#define CACHE_VERSION			2
+#define CACHE_MIN_FILE_SIZE		(4 * 1024 * 1024)
+#define CACHE_MAX_INDEX_SIZE	(1024 * 1024 * 1024)
+
+#define SAMPLE_BLOCK_SIZE		4096
+#define SAMPLE_BLOCK_COUNT		32
+
+#define HASH_OFFSET				Q_UINT64_C(0xcbf29ce484222325)
+#define HASH_PRIME				Q_UINT64_C(0x100000001b3)
+
+bool JsonIndexCache::load(const QString &path, const QByteArray &contents, const QString &text, JsonStructureIndex &index, QBitArray &folds)
+{
+	if (contents.size() < CACHE_MIN_FILE_SIZE)
+	{
+		return false;
+	}
+
+	qint64 timeStart = QDateTime::currentMSecsSinceEpoch();
+
+	QFile file(cacheFileName(path));
+	if (!file.open(QFile::ReadOnly))
+	{
+		return false;
+	}
+
+	uchar *mapped = file.map(0, file.size());
+	if (mapped == NULL)
+	{
+		return false;
+	}
+
+	// The stream reads straight from the mapping.  The index is copied out of it once, as the
+	// index has to outlive the mapping and keeps its tables in vectors of its own.
+	QByteArray data = QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), int(file.size()));
+	QDataStream stream(data);
+	stream.setVersion(QDataStream::Qt_5_0);
+
+	Header header;
+	bool loaded = readHeader(stream, header) && matches(header, path) &&
+				  header.size == contents.size() && header.hash == sampledHash(contents) &&
+				  index.load(stream, text);
+
+	if (loaded)
+	{
+		stream.device()->seek(header.foldOffset);
+		stream >> folds;
+		if (stream.status() != QDataStream::Ok || folds.size() != index.containerCount())
+		{
+			folds.clear();
+		}
+	}
+
+	file.unmap(mapped);
+
+	if (loaded)
+	{
+		qDebug("time to load cached index: %lld ms", QDateTime::currentMSecsSinceEpoch() - timeStart);
+	}
+	return loaded;
+}
+
+bool JsonIndexCache::save(const QString &path, const QByteArray &contents, const JsonStructureIndex &index)
+{
+	// Small files are quicker to index than to look up, and incomplete documents can't be cached.
+	if (contents.size() < CACHE_MIN_FILE_SIZE || !index.isAtTopLevel() ||
+		qint64(index.containerCount()) * sizeof(JsonStructureIndex::Container) > CACHE_MAX_INDEX_SIZE)
+	{
+		return false;
+	}
+
+	QFileInfo info(path);
+	QString fileName = cacheFileName(path);
+	QDir().mkpath(QFileInfo(fileName).absolutePath());
+
+	QSaveFile file(fileName);
+	if (!file.open(QFile::WriteOnly))
+	{
+		return false;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_0);
+	stream << quint32(CACHE_MAGIC) << quint32(CACHE_VERSION);
+	stream << info.absoluteFilePath() << qint64(contents.size()) << info.lastModified().toMSecsSinceEpoch() << sampledHash(contents);
+
+	// The fold state is written last, so it can be replaced without touching the index.
+	qint64 foldOffsetPosition = file.pos();
+	stream << qint64(0);
+	index.save(stream);
+
+	qint64 foldOffset = file.pos();
+	stream << QBitArray(index.containerCount());
+
+	file.seek(foldOffsetPosition);
+	stream << foldOffset;
+
+	return stream.status() == QDataStream::Ok && file.commit();
+}
+
+bool JsonIndexCache::saveFolds(const QString &path, const QBitArray &folds)
+{
+	QFile file(cacheFileName(path));
+	if (!file.exists() || !file.open(QFile::ReadWrite))
+	{
+		return false;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_0);
+
+	Header header;
+	if (!readHeader(stream, header) || !matches(header, path) || QFileInfo(path).size() != header.size)
+	{
+		return false;
+	}
+
+	file.seek(header.foldOffset);
+	stream << folds;
+	file.resize(file.pos());
+	return stream.status() == QDataStream::Ok;
+}
+
+QString JsonIndexCache::cacheFileName(const QString &path)
+{
+	QByteArray key = QCryptographicHash::hash(QFileInfo(path).absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+	return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/index/" + QString::fromLatin1(key) + ".idx";
+}
+
+bool JsonIndexCache::readHeader(QDataStream &stream, Header &header)
+{
+	quint32 magic, version;
+	stream >> magic >> version;
+	if (stream.status() != QDataStream::Ok || magic != CACHE_MAGIC || version != CACHE_VERSION)
+	{
+		return false;
+	}
+
+	stream >> header.path >> header.size >> header.modified >> header.hash >> header.foldOffset;
+	return stream.status() == QDataStream::Ok && header.foldOffset > 0;
+}
+
+bool JsonIndexCache::matches(const Header &header, const QString &path)
+{
+	QFileInfo info(path);
+	return header.path == info.absoluteFilePath() && header.modified == info.lastModified().toMSecsSinceEpoch();
+}
+
+quint64 JsonIndexCache::sampledHash(const QByteArray &contents)
+{
+	// Reading every byte of a large file would cost as much as indexing it, so only evenly spaced blocks are hashed.
+	const uchar *data = reinterpret_cast<const uchar *>(contents.constData());
+	const qint64 size = contents.size();
+	quint64 hash = HASH_OFFSET ^ quint64(size);
+
+	if (size <= qint64(SAMPLE_BLOCK_SIZE) * SAMPLE_BLOCK_COUNT)
+	{
+		for (qint64 i = 0; i < size; i++)
+		{
+			hash = (hash ^ data[i]) * HASH_PRIME;
+		}
+		return hash;
+	}
+
+	for (int block = 0; block < SAMPLE_BLOCK_COUNT; block++)
+	{
+		qint64 start = (size - SAMPLE_BLOCK_SIZE) * block / (SAMPLE_BLOCK_COUNT - 1);
+		for (qint64 i = start; i < start + SAMPLE_BLOCK_SIZE; i++)
+		{
+			hash = (hash ^ data[i]) * HASH_PRIME;
+		}
+	}
+	return hash;
+}
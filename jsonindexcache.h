@@ -0,0 +1,47 @@
+/**
+ * @file jsonindexcache.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief On-disk cache of structure indexes and fold state for large files.
+ */
+#ifndef JSONINDEXCACHE_H
+#define JSONINDEXCACHE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QBitArray>
+#include "jsonstructureindex.h"
+
+class QDataStream;
+
+/**
+ * Each cached file gets one binary cache entry in the user's cache directory, keyed by the
+ * file's path, size, modification time and a hash of blocks sampled across its contents.
+ * The entry holds the structure index of the file and the fold state from the last
+ * session; it is memory-mapped when read back.
+ */
+class JsonIndexCache
+{
+public:
+	static bool load(const QString &path, const QByteArray &contents, const QString &text, JsonStructureIndex &index, QBitArray &folds);
+	static bool save(const QString &path, const QByteArray &contents, const JsonStructureIndex &index);
+	static bool saveFolds(const QString &path, const QBitArray &folds);
+
+private:
+	struct Header
+	{
+		QString path;
+		qint64 size;
+		qint64 modified;
+		quint64 hash;
+		qint64 foldOffset;
+	};
+
+	static QString cacheFileName(const QString &path);
+	static bool readHeader(QDataStream &stream, Header &header);
+	static bool matches(const Header &header, const QString &path);
+	static quint64 sampledHash(const QByteArray &contents);
+};
+
+#endif // JSONINDEXCACHE_H
@@ -0,0 +1,472 @@
+/**
+ * @file jsonjournal.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsonjournal.h"
+#include "jsonstructureindex.h"
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QLockFile>
+#include <QAtomicInt>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <cstring>
+
+#if defined(Q_OS_WIN)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+#define JOURNAL_MAGIC			0x4a504a4c		// "JPJL"
+#define JOURNAL_VERSION			1
+#define JOURNAL_FLUSH_INTERVAL	250
+#define JOURNAL_FLUSH_BYTES		(1024 * 1024)
+#define JOURNAL_COMPACT_BYTES	(64 * 1024 * 1024)
+#define REPLAY_GAP_SIZE			(64 * 1024)
+
+enum JournalRecordType
+{
+	FileBaseRecord = 1,
+	TextBaseRecord,
+	EditRecord
+};
+
+template <typename T>
+static inline void appendValue(QByteArray &data, T value)
+{
+	data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+static inline void appendString(QByteArray &data, const QString &string)
+{
+	appendValue(data, qint32(string.length()));
+	data.append(reinterpret_cast<const char *>(string.constData()), string.length() * int(sizeof(QChar)));
+}
+
+template <typename T>
+static inline bool readValue(const char *&position, const char *end, T &value)
+{
+	if (end - position < qint64(sizeof(value)))
+	{
+		return false;
+	}
+	memcpy(&value, position, sizeof(value));
+	position += sizeof(value);
+	return true;
+}
+
+static inline bool readString(const char *&position, const char *end, QString &string)
+{
+	qint32 length;
+	if (!readValue(position, end, length) || length < 0 || (end - position) / qint64(sizeof(QChar)) < length)
+	{
+		return false;
+	}
+	string = QString(reinterpret_cast<const QChar *>(position), length);
+	position += length * qint64(sizeof(QChar));
+	return true;
+}
+
+/**
+ * Edits are replayed into a gap buffer, so a run of typing in one place costs no more than
+ * the typing itself, however large the document is.
+ */
+class JournalGapBuffer
+{
+public:
+	explicit JournalGapBuffer(const QString &text) :
+		_buffer(text),
+		_gapStart(text.length()),
+		_gapEnd(text.length())
+	{
+	}
+
+	bool replace(int position, int charsRemoved, const QString &charsAdded)
+	{
+		int length = _buffer.length() - (_gapEnd - _gapStart);
+		if (position < 0 || charsRemoved < 0 || position > length - charsRemoved)
+		{
+			return false;
+		}
+
+		moveGap(position);
+		_gapEnd += charsRemoved;
+		if (_gapEnd - _gapStart < charsAdded.length())
+		{
+			grow(charsAdded.length());
+		}
+		memcpy(_buffer.data() + _gapStart, charsAdded.constData(), charsAdded.length() * sizeof(QChar));
+		_gapStart += charsAdded.length();
+		return true;
+	}
+
+	QString text() const
+	{
+		return _buffer.left(_gapStart) + _buffer.mid(_gapEnd);
+	}
+
+private:
+	void moveGap(int position)
+	{
+		QChar *data = _buffer.data();
+		if (position < _gapStart)
+		{
+			int count = _gapStart - position;
+			memmove(data + _gapEnd - count, data + position, count * sizeof(QChar));
+			_gapStart -= count;
+			_gapEnd -= count;
+		}
+		else if (position > _gapStart)
+		{
+			int count = position - _gapStart;
+			memmove(data + _gapStart, data + _gapEnd, count * sizeof(QChar));
+			_gapStart += count;
+			_gapEnd += count;
+		}
+	}
+
+	void grow(int needed)
+	{
+		int extra = qMax(needed, REPLAY_GAP_SIZE);
+		int tail = _buffer.length() - _gapEnd;
+		_buffer.resize(_buffer.length() + extra);
+		QChar *data = _buffer.data();
+		memmove(data + _gapEnd + extra, data + _gapEnd, tail * sizeof(QChar));
+		_gapEnd += extra;
+	}
+
+	QString _buffer;
+	int _gapStart;
+	int _gapEnd;
+};
+
+JsonJournal::JsonJournal(QObject *parent) :
+	QObject(parent),
+	_lock(NULL),
+	_writer(NULL),
+	_baseBytes(0),
+	_editBytes(0),
+	_compactionRequested(false)
+{
+	QString directory = journalDirectory();
+	QDir().mkpath(directory);
+	// Every open document has a journal of its own.
+	static QAtomicInt nextJournal;
+	QString fileName = directory + QString("/%1-%2.journal").arg(QCoreApplication::applicationPid()).arg(nextJournal.fetchAndAddRelaxed(1));
+
+	_lock = new QLockFile(fileName + ".lock");
+	_lock->tryLock(0);
+
+	_writer = new JsonJournalWriter(fileName);
+	_writer->moveToThread(&_thread);
+	connect(this, &JsonJournal::writeBase, _writer, &JsonJournalWriter::writeBase);
+	connect(this, &JsonJournal::writeTextBase, _writer, &JsonJournalWriter::writeTextBase);
+	connect(this, &JsonJournal::writeRecords, _writer, &JsonJournalWriter::writeRecords);
+	connect(this, &JsonJournal::removeJournal, _writer, &JsonJournalWriter::removeJournal);
+	connect(this, &JsonJournal::stopWriting, _writer, &JsonJournalWriter::stopWriting);
+	_thread.start(QThread::LowPriority);
+
+	_flushTimer.setSingleShot(true);
+	_flushTimer.setInterval(JOURNAL_FLUSH_INTERVAL);
+	connect(&_flushTimer, &QTimer::timeout, this, &JsonJournal::flush);
+}
+
+JsonJournal::~JsonJournal()
+{
+	// Anything still queued is written before the thread stops.
+	flush();
+	emit stopWriting();
+	_thread.wait();
+	delete _writer;
+	delete _lock;
+}
+
+void JsonJournal::resetToFile(const QString &path)
+{
+	QFileInfo info(path);
+
+	QByteArray base;
+	appendValue(base, qint32(FileBaseRecord));
+	appendString(base, info.absoluteFilePath());
+	appendValue(base, qint64(info.size()));
+	appendValue(base, qint64(info.lastModified().toMSecsSinceEpoch()));
+
+	resetCounters(info.size());
+	emit writeBase(base);
+}
+
+void JsonJournal::resetToText(const QString &text)
+{
+	// The text may contain fold markers; the writer drops them.
+	resetCounters(text.length() * qint64(sizeof(QChar)));
+	emit writeTextBase(text);
+}
+
+void JsonJournal::discard()
+{
+	_flushTimer.stop();
+	_pending.clear();
+	emit removeJournal();
+}
+
+void JsonJournal::record(int position, int charsRemoved, const QString &charsAdded)
+{
+	appendValue(_pending, qint32(EditRecord));
+	appendValue(_pending, qint32(position));
+	appendValue(_pending, qint32(charsRemoved));
+	appendString(_pending, charsAdded);
+
+	if (_pending.size() >= JOURNAL_FLUSH_BYTES)
+	{
+		flush();
+	}
+	else if (!_flushTimer.isActive())
+	{
+		_flushTimer.start();
+	}
+}
+
+void JsonJournal::flush()
+{
+	_flushTimer.stop();
+	if (_pending.isEmpty())
+	{
+		return;
+	}
+
+	_editBytes += _pending.size();
+	emit writeRecords(_pending);
+	_pending.clear();
+
+	// Once the edits outweigh the base, replaying them would take longer than reading a fresh copy.
+	if (!_compactionRequested && _editBytes > JOURNAL_COMPACT_BYTES && _editBytes > _baseBytes)
+	{
+		_compactionRequested = true;
+		emit compactionNeeded();
+	}
+}
+
+void JsonJournal::resetCounters(qint64 baseBytes)
+{
+	// Pending edits are already part of the new base.
+	_flushTimer.stop();
+	_pending.clear();
+	_baseBytes = baseBytes;
+	_editBytes = 0;
+	_compactionRequested = false;
+}
+
+bool JsonJournal::recover(QString &path, QString &text)
+{
+	QDir directory(journalDirectory());
+	QString ownPrefix = QString("%1-").arg(QCoreApplication::applicationPid());
+
+	foreach (const QFileInfo &info, directory.entryInfoList(QStringList() << "*.journal", QDir::Files, QDir::Time))
+	{
+		if (info.fileName().startsWith(ownPrefix))
+		{
+			continue;
+		}
+
+		// A journal whose lock can be taken was left behind by a session that didn't exit cleanly.
+		QLockFile lock(info.absoluteFilePath() + ".lock");
+		lock.setStaleLockTime(0);
+		if (!lock.tryLock(0))
+		{
+			continue;
+		}
+
+		bool recovered = replay(info.absoluteFilePath(), path, text);
+		QFile::remove(info.absoluteFilePath());
+		if (recovered)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+QString JsonJournal::journalDirectory()
+{
+	return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/recovery";
+}
+
+bool JsonJournal::replay(const QString &fileName, QString &path, QString &text)
+{
+	qint64 timeStart = QDateTime::currentMSecsSinceEpoch();
+
+	QFile file(fileName);
+	if (!file.open(QFile::ReadOnly) || file.size() == 0)
+	{
+		return false;
+	}
+
+	uchar *mapped = file.map(0, file.size());
+	if (mapped == NULL)
+	{
+		return false;
+	}
+
+	const char *position = reinterpret_cast<const char *>(mapped);
+	const char *end = position + file.size();
+
+	quint32 magic, version;
+	qint32 type;
+	bool valid = readValue(position, end, magic) && magic == JOURNAL_MAGIC &&
+				 readValue(position, end, version) && version == JOURNAL_VERSION &&
+				 readValue(position, end, type);
+
+	QString base;
+	if (valid && type == FileBaseRecord)
+	{
+		qint64 size, modified;
+		valid = readString(position, end, path) && readValue(position, end, size) && readValue(position, end, modified);
+
+		// The edits only apply to the file as it was when they were made.
+		QFileInfo info(path);
+		QFile baseFile(path);
+		valid = valid && info.size() == size && info.lastModified().toMSecsSinceEpoch() == modified && baseFile.open(QFile::ReadOnly);
+		if (valid)
+		{
+			base = QString::fromUtf8(baseFile.readAll());
+		}
+	}
+	else if (valid && type == TextBaseRecord)
+	{
+		path.clear();
+		valid = readString(position, end, base);
+	}
+	else
+	{
+		valid = false;
+	}
+
+	int edits = 0;
+	if (valid)
+	{
+		JournalGapBuffer buffer(base);
+
+		// A record cut short by the crash ends the journal.
+		qint32 recordType, recordPosition, charsRemoved;
+		QString charsAdded;
+		while (readValue(position, end, recordType) && recordType == EditRecord &&
+			   readValue(position, end, recordPosition) && readValue(position, end, charsRemoved) &&
+			   readString(position, end, charsAdded) && buffer.replace(recordPosition, charsRemoved, charsAdded))
+		{
+			edits++;
+		}
+		text = buffer.text();
+	}
+
+	file.unmap(mapped);
+
+	if (valid)
+	{
+		qDebug("time to replay %d journal edits: %lld ms", edits, QDateTime::currentMSecsSinceEpoch() - timeStart);
+	}
+
+	// A file with no edits on top of it has nothing to recover.
+	return valid && (edits > 0 || (type == TextBaseRecord && !text.isEmpty()));
+}
+
+JsonJournalWriter::JsonJournalWriter(const QString &fileName) :
+	QObject(),
+	_fileName(fileName),
+	_file(fileName, this)
+{
+}
+
+JsonJournalWriter::~JsonJournalWriter()
+{
+}
+
+void JsonJournalWriter::writeBase(const QByteArray &base)
+{
+	QSaveFile file(_fileName);
+	if (file.open(QFile::WriteOnly) && writeHeader(file))
+	{
+		file.write(base);
+		sync(file);
+		file.commit();
+	}
+	reopen();
+}
+
+void JsonJournalWriter::writeTextBase(const QString &text)
+{
+	QSaveFile file(_fileName);
+	if (file.open(QFile::WriteOnly) && writeHeader(file))
+	{
+		QByteArray header;
+		appendValue(header, qint32(TextBaseRecord));
+		appendValue(header, qint32(text.length() - text.count(QChar(HIDDEN_CHAR))));
+		file.write(header);
+
+		// Write the runs of text between fold markers straight from the string.
+		const QChar *data = text.constData();
+		int runStart = 0;
+		for (int i = 0; i <= text.length(); i++)
+		{
+			if (i == text.length() || data[i] == HIDDEN_CHAR)
+			{
+				file.write(reinterpret_cast<const char *>(data + runStart), qint64(i - runStart) * sizeof(QChar));
+				runStart = i + 1;
+			}
+		}
+
+		sync(file);
+		file.commit();
+	}
+	reopen();
+}
+
+void JsonJournalWriter::writeRecords(const QByteArray &records)
+{
+	if (_file.isOpen())
+	{
+		_file.write(records);
+		sync(_file);
+	}
+}
+
+void JsonJournalWriter::removeJournal()
+{
+	_file.close();
+	QFile::remove(_fileName);
+}
+
+void JsonJournalWriter::stopWriting()
+{
+	_file.close();
+	QThread::currentThread()->quit();
+}
+
+bool JsonJournalWriter::writeHeader(QFileDevice &file)
+{
+	QByteArray header;
+	appendValue(header, quint32(JOURNAL_MAGIC));
+	appendValue(header, quint32(JOURNAL_VERSION));
+	return file.write(header) == header.size();
+}
+
+void JsonJournalWriter::reopen()
+{
+	_file.close();
+	_file.open(QFile::WriteOnly | QFile::Append);
+}
+
+void JsonJournalWriter::sync(QFileDevice &file)
+{
+	file.flush();
+#if defined(Q_OS_WIN)
+	_commit(file.handle());
+#else
+	fsync(file.handle());
+#endif
+}
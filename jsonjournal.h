@@ -0,0 +1,99 @@
+/**
+ * @file jsonjournal.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Append-only journal of edits, used to recover unsaved work after a crash.
+ */
+#ifndef JSONJOURNAL_H
+#define JSONJOURNAL_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QFile>
+#include <QThread>
+#include <QTimer>
+
+class QLockFile;
+class JsonJournalWriter;
+
+/**
+ * The journal starts from a base, which is either a reference to an unmodified file on
+ * disk or a full copy of the text, followed by one small record per edit.  Recording an
+ * edit only appends to a buffer; the buffer is written and synced to disk in batches on
+ * a background thread.  Once the edits outgrow the base, compactionNeeded() asks the
+ * owner for a fresh copy of the text to start over from.
+ *
+ * Every document keeps its own journal next to a lock file, so a journal whose lock can
+ * be taken belongs to a session that ended without cleaning up.  Each call to recover()
+ * restores one of them.
+ */
+class JsonJournal : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit JsonJournal(QObject *parent = nullptr);
+	virtual ~JsonJournal();
+
+	void resetToFile(const QString &path);
+	void resetToText(const QString &text);
+	void discard();
+
+	static bool recover(QString &path, QString &text);
+
+public slots:
+	void record(int position, int charsRemoved, const QString &charsAdded);
+	void flush();
+
+signals:
+	void compactionNeeded();
+
+	void writeBase(const QByteArray &base);
+	void writeTextBase(const QString &text);
+	void writeRecords(const QByteArray &records);
+	void removeJournal();
+	void stopWriting();
+
+private:
+	void resetCounters(qint64 baseBytes);
+
+	static QString journalDirectory();
+	static bool replay(const QString &fileName, QString &path, QString &text);
+
+	QLockFile *_lock;
+	QThread _thread;
+	JsonJournalWriter *_writer;
+	QTimer _flushTimer;
+
+	QByteArray _pending;
+	qint64 _baseBytes;
+	qint64 _editBytes;
+	bool _compactionRequested;
+};
+
+class JsonJournalWriter : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit JsonJournalWriter(const QString &fileName);
+	virtual ~JsonJournalWriter();
+
+public slots:
+	void writeBase(const QByteArray &base);
+	void writeTextBase(const QString &text);
+	void writeRecords(const QByteArray &records);
+	void removeJournal();
+	void stopWriting();
+
+private:
+	bool writeHeader(QFileDevice &file);
+	void reopen();
+	static void sync(QFileDevice &file);
+
+	QString _fileName;
+	QFile _file;
+};
+
+#endif // JSONJOURNAL_H
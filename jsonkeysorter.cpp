@@ -0,0 +1,198 @@
+/**
+ * @file jsonkeysorter.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsonkeysorter.h"
+#include <QDateTime>
+#include <algorithm>
+
+JsonKeySorter::JsonKeySorter()
+{
+}
+
+void JsonKeySorter::clear()
+{
+	_segments.clear();
+	_byOriginal.clear();
+}
+
+qint64 JsonKeySorter::memoryUsage() const
+{
+	return qint64(_segments.capacity()) * sizeof(Segment) + qint64(_byOriginal.capacity()) * sizeof(int);
+}
+
+QString JsonKeySorter::sort(const JsonStructureIndex &index)
+{
+	qint64 timeStart = QDateTime::currentMSecsSinceEpoch();
+
+	clear();
+	const QString &text = index.text();
+
+	QVector<JsonStructureIndex::Member> roots = index.members(-1);
+	if (roots.isEmpty())
+	{
+		return text;
+	}
+	foreach (const JsonStructureIndex::Member &root, roots)
+	{
+		if ((root.container != -1 && index.container(root.container).end < 0) || root.valueEnd < root.valueStart || root.valueEnd >= text.length())
+		{
+			return text;
+		}
+	}
+
+	struct Frame
+	{
+		int container;
+		QVector<JsonStructureIndex::Member> members;
+		int next;
+		int copiedTo;		///< Original offset the text of an array has been copied up to.
+	};
+
+	QString sorted;
+	sorted.reserve(text.length());
+
+	// Containers are walked with an explicit stack, so deeply nested documents can't overflow.
+	// Everything outside of the reordered objects, such as the text between top-level values
+	// and the separators of arrays, is copied as it is.
+	QVector<Frame> stack;
+	int copiedTo = 0;
+	for (int r = 0; r < roots.count(); r++)
+	{
+		const JsonStructureIndex::Member &rootMember = roots.at(r);
+		copy(text, copiedTo, rootMember.valueStart - copiedTo, sorted);
+		copiedTo = rootMember.valueEnd + 1;
+
+		Frame root = { -1, QVector<JsonStructureIndex::Member>() << rootMember, 0, -1 };
+		stack.append(root);
+
+		while (!stack.isEmpty())
+		{
+			Frame &frame = stack.last();
+			if (frame.next == frame.members.count())
+			{
+				if (frame.container != -1)
+				{
+					const JsonStructureIndex::Container &container = index.container(frame.container);
+					if (container.isArray)
+					{
+						copy(text, frame.copiedTo, container.end - frame.copiedTo + 1, sorted);
+					}
+					else
+					{
+						copy(text, container.end, 1, sorted);
+					}
+				}
+				stack.removeLast();
+				continue;
+			}
+
+			const JsonStructureIndex::Member member = frame.members.at(frame.next++);
+			if (frame.container != -1 && index.container(frame.container).isArray)
+			{
+				copy(text, frame.copiedTo, member.valueStart - frame.copiedTo, sorted);
+				frame.copiedTo = member.valueEnd + 1;
+			}
+			else if (frame.container != -1 && member.index > 0)
+			{
+				sorted += ',';
+			}
+			if (member.keyStart != -1)
+			{
+				copy(text, member.keyStart, member.keyLength, sorted);
+				sorted += ':';
+			}
+
+			if (member.container == -1 || index.container(member.container).folded)
+			{
+				copy(text, member.valueStart, member.valueEnd - member.valueStart + 1, sorted);
+				continue;
+			}
+
+			const JsonStructureIndex::Container &container = index.container(member.container);
+			QVector<JsonStructureIndex::Member> members = index.members(member.container);
+			if (!container.isArray)
+			{
+				std::stable_sort(members.begin(), members.end(), [&text](const JsonStructureIndex::Member &left, const JsonStructureIndex::Member &right)
+				{
+					return text.midRef(left.keyStart + 1, left.keyLength - 2) < text.midRef(right.keyStart + 1, right.keyLength - 2);
+				});
+
+				// Separators are written by position in the sorted order.
+				for (int i = 0; i < members.count(); i++)
+				{
+					members[i].index = i;
+				}
+			}
+
+			copy(text, container.start, 1, sorted);
+			Frame child = { member.container, members, 0, container.start + 1 };
+			stack.append(child);
+		}
+	}
+	copy(text, copiedTo, text.length() - copiedTo, sorted);
+
+	_byOriginal.resize(_segments.count());
+	for (int i = 0; i < _byOriginal.count(); i++)
+	{
+		_byOriginal[i] = i;
+	}
+	std::sort(_byOriginal.begin(), _byOriginal.end(), [this](int left, int right)
+	{
+		return _segments.at(left).original < _segments.at(right).original;
+	});
+
+	qDebug("time to sort keys: %lld ms", QDateTime::currentMSecsSinceEpoch() - timeStart);
+	return sorted;
+}
+
+int JsonKeySorter::toSorted(int position) const
+{
+	if (_segments.isEmpty())
+	{
+		return position;
+	}
+
+	QVector<int>::const_iterator it = std::upper_bound(_byOriginal.constBegin(), _byOriginal.constEnd(), position,
+														[this](int value, int segment) { return value < _segments.at(segment).original; });
+	if (it == _byOriginal.constBegin())
+	{
+		return 0;
+	}
+
+	const Segment &segment = _segments.at(*(it - 1));
+	return segment.sorted + qMin(position - segment.original, segment.length);
+}
+
+int JsonKeySorter::fromSorted(int position) const
+{
+	if (_segments.isEmpty())
+	{
+		return position;
+	}
+
+	QVector<Segment>::const_iterator it = std::upper_bound(_segments.constBegin(), _segments.constEnd(), position,
+														  [](int value, const Segment &segment) { return value < segment.sorted; });
+	if (it == _segments.constBegin())
+	{
+		return 0;
+	}
+
+	const Segment &segment = *(it - 1);
+	return segment.original + qMin(position - segment.sorted, segment.length);
+}
+
+void JsonKeySorter::copy(const QString &text, int from, int length, QString &sorted)
+{
+	if (length <= 0)
+	{
+		return;
+	}
+
+	Segment segment = { sorted.length(), from, length };
+	_segments.append(segment);
+	sorted.append(text.constData() + from, length);
+}
@@ -0,0 +1,50 @@
+/**
+ * @file jsonkeysorter.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Reorders object members by key, keeping track of where everything came from.
+ */
+#ifndef JSONKEYSORTER_H
+#define JSONKEYSORTER_H
+
+#include <QString>
+#include <QVector>
+#include "jsonstructureindex.h"
+
+/**
+ * Produces a copy of an indexed document with every object's members sorted by key.
+ * The copy is assembled from spans of the original text, and those spans are kept so
+ * positions can be translated in either direction with a binary search.
+ *
+ * Folded containers, and everything outside of the objects being reordered, are copied as
+ * they are.  Documents that aren't complete values are left unsorted, in which case the
+ * translation is the identity.
+ */
+class JsonKeySorter
+{
+public:
+	JsonKeySorter();
+
+	void clear();
+	qint64 memoryUsage() const;
+	QString sort(const JsonStructureIndex &index);
+
+	int toSorted(int position) const;
+	int fromSorted(int position) const;
+
+private:
+	struct Segment
+	{
+		int sorted;
+		int original;
+		int length;
+	};
+
+	void copy(const QString &text, int from, int length, QString &sorted);
+
+	QVector<Segment> _segments;			///< In order of sorted offset.
+	QVector<int> _byOriginal;			///< Segment indices in order of original offset.
+};
+
+#endif // JSONKEYSORTER_H
@@ -0,0 +1,190 @@
+/**
+ * @file jsonmemoryusage.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsonmemoryusage.h"
+#include <QSettings>
+#include <QFile>
+
+#ifdef Q_OS_LINUX
+#include <unistd.h>
+#endif
+
+#define BYTES_PER_MEGABYTE		(1024 * 1024)
+
+JsonMemoryUsage::JsonMemoryUsage()
+{
+	for (int i = 0; i < CategoryCount; i++)
+	{
+		_bytes[i] = 0;
+	}
+}
+
+void JsonMemoryUsage::add(Category category, qint64 bytes)
+{
+	_bytes[category] += bytes;
+}
+
+qint64 JsonMemoryUsage::bytes(Category category) const
+{
+	return _bytes[category];
+}
+
+qint64 JsonMemoryUsage::total() const
+{
+	qint64 total = 0;
+	for (int i = 0; i < CategoryCount; i++)
+	{
+		total += _bytes[i];
+	}
+	return total;
+}
+
+JsonMemoryUsage &JsonMemoryUsage::operator+=(const JsonMemoryUsage &other)
+{
+	for (int i = 0; i < CategoryCount; i++)
+	{
+		_bytes[i] += other._bytes[i];
+	}
+	return *this;
+}
+
+QString JsonMemoryUsage::categoryName(Category category)
+{
+	switch (category)
+	{
+		case RawText:
+			return "Raw text";
+		case FormattedText:
+			return "Formatted text";
+		case Layout:
+			return "Layout";
+		case Indexes:
+			return "Indexes";
+		case UndoHistory:
+			return "Undo history";
+		case Caches:
+			return "Caches";
+		default:
+			return QString();
+	}
+}
+
+QString JsonMemoryUsage::formatBytes(qint64 bytes)
+{
+	if (bytes < 1024)
+	{
+		return QString("%1 B").arg(bytes);
+	}
+	if (bytes < BYTES_PER_MEGABYTE)
+	{
+		return QString("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+	}
+	if (bytes < qint64(1024) * BYTES_PER_MEGABYTE)
+	{
+		return QString("%1 MB").arg(bytes / double(BYTES_PER_MEGABYTE), 0, 'f', 1);
+	}
+	return QString("%1 GB").arg(bytes / (1024.0 * BYTES_PER_MEGABYTE), 0, 'f', 2);
+}
+
+QString JsonMemoryUsage::report(const QStringList &names, const QStringList &modes, const QVector<JsonMemoryUsage> &usages)
+{
+	QVector<QStringList> rows;
+	QStringList header;
+	header << "Document" << "Mode";
+	for (int i = 0; i < CategoryCount; i++)
+	{
+		header << categoryName(Category(i));
+	}
+	header << "Total";
+	rows.append(header);
+
+	JsonMemoryUsage sum;
+	for (int i = 0; i < usages.count(); i++)
+	{
+		QStringList row;
+		row << names.at(i) << modes.at(i);
+		for (int j = 0; j < CategoryCount; j++)
+		{
+			row << formatBytes(usages.at(i).bytes(Category(j)));
+		}
+		row << formatBytes(usages.at(i).total());
+		rows.append(row);
+		sum += usages.at(i);
+	}
+
+	QStringList totals;
+	totals << "All documents" << QString();
+	for (int i = 0; i < CategoryCount; i++)
+	{
+		totals << formatBytes(sum.bytes(Category(i)));
+	}
+	totals << formatBytes(sum.total());
+	rows.append(totals);
+
+	// Names and modes line up on the left, sizes on the right.
+	QVector<int> widths(header.count());
+	for (int i = 0; i < rows.count(); i++)
+	{
+		for (int j = 0; j < rows.at(i).count(); j++)
+		{
+			widths[j] = qMax(widths.at(j), rows.at(i).at(j).length());
+		}
+	}
+
+	QString text;
+	for (int i = 0; i < rows.count(); i++)
+	{
+		QStringList cells;
+		for (int j = 0; j < rows.at(i).count(); j++)
+		{
+			cells << (j < 2 ? rows.at(i).at(j).leftJustified(widths.at(j)) : rows.at(i).at(j).rightJustified(widths.at(j)));
+		}
+		text += cells.join("  ") + "\n";
+	}
+
+	qint64 resident = processResidentSize();
+	if (resident > 0)
+	{
+		text += QString("\nProcess resident size: %1 (%2 not accounted for above)\n")
+				.arg(formatBytes(resident), formatBytes(qMax(Q_INT64_C(0), resident - sum.total())));
+	}
+	return text;
+}
+
+qint64 JsonMemoryUsage::processResidentSize()
+{
+#ifdef Q_OS_LINUX
+	// The second field of statm is the resident size, in pages.
+	QFile statm("/proc/self/statm");
+	if (statm.open(QFile::ReadOnly))
+	{
+		QList<QByteArray> fields = statm.readAll().split(' ');
+		if (fields.count() > 1)
+		{
+			return fields.at(1).toLongLong() * sysconf(_SC_PAGESIZE);
+		}
+	}
+#endif
+	return -1;
+}
+
+qint64 JsonMemoryUsage::documentCap()
+{
+	QSettings settings;
+	settings.beginGroup("memory");
+	qint64 megabytes = qMax(0, settings.value("documentCapMegabytes", 0).toInt());
+	settings.endGroup();
+	return megabytes * BYTES_PER_MEGABYTE;
+}
+
+void JsonMemoryUsage::setDocumentCap(qint64 bytes)
+{
+	QSettings settings;
+	settings.beginGroup("memory");
+	settings.setValue("documentCapMegabytes", int(bytes / BYTES_PER_MEGABYTE));
+	settings.endGroup();
+}
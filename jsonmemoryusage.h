@@ -0,0 +1,54 @@
+/**
+ * @file jsonmemoryusage.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Bytes held by a document, by what they are held for.
+ */
+#ifndef JSONMEMORYUSAGE_H
+#define JSONMEMORYUSAGE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * Sizes are taken from the capacity of the strings and vectors involved.  Qt doesn't
+ * report what a QTextDocument spends on laying out its blocks or on its undo stack, so
+ * those two are estimated from the number of blocks and undo steps.
+ */
+class JsonMemoryUsage
+{
+public:
+	enum Category
+	{
+		RawText,
+		FormattedText,
+		Layout,
+		Indexes,
+		UndoHistory,
+		Caches,
+		CategoryCount
+	};
+
+	JsonMemoryUsage();
+
+	void add(Category category, qint64 bytes);
+	qint64 bytes(Category category) const;
+	qint64 total() const;
+
+	JsonMemoryUsage &operator+=(const JsonMemoryUsage &other);
+
+	static QString categoryName(Category category);
+	static QString formatBytes(qint64 bytes);
+	static QString report(const QStringList &names, const QStringList &modes, const QVector<JsonMemoryUsage> &usages);
+	static qint64 processResidentSize();
+
+	static qint64 documentCap();
+	static void setDocumentCap(qint64 bytes);
+
+private:
+	qint64 _bytes[CategoryCount];
+};
+
+#endif // JSONMEMORYUSAGE_H
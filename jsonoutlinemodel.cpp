@@ -0,0 +1,227 @@
+/**
+ * @file jsonoutlinemodel.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsonoutlinemodel.h"
+
+#define VALUE_PREVIEW_LENGTH	80
+
+JsonOutlineModel::JsonOutlineModel(QObject *parent) :
+	QAbstractItemModel(parent),
+	_index(NULL)
+{
+	_root = new Node();
+	_root->parent = NULL;
+	_root->row = 0;
+	_root->member.container = -1;
+}
+
+JsonOutlineModel::~JsonOutlineModel()
+{
+	deleteChildren(_root);
+	delete _root;
+}
+
+void JsonOutlineModel::setStructureIndex(const JsonStructureIndex *index)
+{
+	beginResetModel();
+	deleteChildren(_root);
+	_index = index;
+	endResetModel();
+}
+
+int JsonOutlineModel::offset(const QModelIndex &index) const
+{
+	Node *node = nodeFromIndex(index);
+	if (node == _root)
+	{
+		return -1;
+	}
+	return node->member.keyStart != -1 ? node->member.keyStart : node->member.valueStart;
+}
+
+QModelIndex JsonOutlineModel::indexForOffset(int offset)
+{
+	if (_index == NULL || _index->isEmpty())
+	{
+		return QModelIndex();
+	}
+
+	// Collect the chain of enclosing containers, innermost first.
+	QVector<int> chain;
+	for (int container = _index->containerAt(offset); container != -1; container = _index->container(container).parent)
+	{
+		chain.append(container);
+	}
+	if (chain.isEmpty())
+	{
+		// Outside every container there can only be a top-level scalar.
+		JsonStructureIndex::Member root = _index->memberAt(-1, offset);
+		return root.index != -1 ? index(root.index, 0) : QModelIndex();
+	}
+
+	// Then walk back down, creating only the nodes along the path.
+	QModelIndex result;
+	for (int i = chain.count() - 1; i >= 0; i--)
+	{
+		result = index(_index->container(chain.at(i)).indexInParent, 0, result);
+	}
+
+	// Finally select the scalar member under the offset, if any.
+	JsonStructureIndex::Member member = _index->memberAt(chain.first(), offset);
+	if (member.index != -1 && member.container == -1)
+	{
+		result = index(member.index, 0, result);
+	}
+	return result;
+}
+
+QModelIndex JsonOutlineModel::index(int row, int column, const QModelIndex &parent) const
+{
+	Node *parentNode = nodeFromIndex(parent);
+	if (_index == NULL || row < 0 || column < 0 || column >= 2 || row >= childCount(parentNode))
+	{
+		return QModelIndex();
+	}
+
+	Node *node = childNode(parentNode, row);
+	return node != NULL ? createIndex(row, column, node) : QModelIndex();
+}
+
+QModelIndex JsonOutlineModel::parent(const QModelIndex &child) const
+{
+	Node *node = nodeFromIndex(child);
+	if (node == _root || node->parent == _root)
+	{
+		return QModelIndex();
+	}
+	return createIndex(node->parent->row, 0, node->parent);
+}
+
+int JsonOutlineModel::rowCount(const QModelIndex &parent) const
+{
+	if (parent.column() > 0)
+	{
+		return 0;
+	}
+	return childCount(nodeFromIndex(parent));
+}
+
+int JsonOutlineModel::columnCount(const QModelIndex &) const
+{
+	return 2;
+}
+
+bool JsonOutlineModel::hasChildren(const QModelIndex &parent) const
+{
+	return rowCount(parent) > 0;
+}
+
+QVariant JsonOutlineModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid() || role != Qt::DisplayRole)
+	{
+		return QVariant();
+	}
+
+	Node *node = nodeFromIndex(index);
+	const JsonStructureIndex::Member &member = node->member;
+
+	if (index.column() == 0)
+	{
+		if (node->parent == _root)
+		{
+			return _index->rootCount() > 1 ? QString("$[%1]").arg(node->row) : QString("$");
+		}
+		if (member.keyStart != -1)
+		{
+			return _index->keyName(member);
+		}
+		return QString("[%1]").arg(member.index);
+	}
+
+	if (member.container != -1)
+	{
+		const JsonStructureIndex::Container &container = _index->container(member.container);
+		return container.isArray ? QString("[%1]").arg(container.childCount) : QString("{%1}").arg(container.childCount);
+	}
+
+	int length = member.valueEnd - member.valueStart + 1;
+	if (length > VALUE_PREVIEW_LENGTH)
+	{
+		return _index->text().mid(member.valueStart, VALUE_PREVIEW_LENGTH) + ELLIPSES;
+	}
+	return _index->text().mid(member.valueStart, length);
+}
+
+QVariant JsonOutlineModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+	if (orientation == Qt::Horizontal && role == Qt::DisplayRole)
+	{
+		return section == 0 ? QString("Key") : QString("Value");
+	}
+	return QVariant();
+}
+
+JsonOutlineModel::Node *JsonOutlineModel::nodeFromIndex(const QModelIndex &index) const
+{
+	return index.isValid() ? static_cast<Node *>(index.internalPointer()) : _root;
+}
+
+JsonOutlineModel::Node *JsonOutlineModel::childNode(Node *parent, int row) const
+{
+	// Child nodes are only created once they are asked for.
+	if (parent->children.isEmpty())
+	{
+		parent->children.fill(NULL, childCount(parent));
+	}
+
+	Node *&child = parent->children[row];
+	if (child == NULL)
+	{
+		JsonStructureIndex::Member member = _index->member(parent->member.container, row);
+		if (member.index == -1)
+		{
+			return NULL;
+		}
+
+		child = new Node();
+		child->parent = parent;
+		child->row = row;
+		child->member = member;
+	}
+	return child;
+}
+
+int JsonOutlineModel::childCount(const Node *node) const
+{
+	if (_index == NULL)
+	{
+		return 0;
+	}
+	if (node == _root)
+	{
+		return _index->rootCount();
+	}
+	if (node->member.container == -1)
+	{
+		return 0;
+	}
+	return _index->memberCount(node->member.container);
+}
+
+void JsonOutlineModel::deleteChildren(Node *node)
+{
+	foreach (Node *child, node->children)
+	{
+		if (child != NULL)
+		{
+			deleteChildren(child);
+			delete child;
+		}
+	}
+	node->children.clear();
+}
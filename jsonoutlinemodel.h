@@ -0,0 +1,53 @@
+/**
+ * @file jsonoutlinemodel.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Tree model of keys and array indices, populated lazily from a JsonStructureIndex.
+ */
+#ifndef JSONOUTLINEMODEL_H
+#define JSONOUTLINEMODEL_H
+
+#include <QAbstractItemModel>
+#include "jsonstructureindex.h"
+
+class JsonOutlineModel : public QAbstractItemModel
+{
+	Q_OBJECT
+
+public:
+	explicit JsonOutlineModel(QObject *parent = nullptr);
+	virtual ~JsonOutlineModel();
+
+	void setStructureIndex(const JsonStructureIndex *index);
+
+	int offset(const QModelIndex &index) const;
+	QModelIndex indexForOffset(int offset);
+
+	QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+	QModelIndex parent(const QModelIndex &child) const;
+	int rowCount(const QModelIndex &parent = QModelIndex()) const;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const;
+	bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+	QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+	QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+private:
+	struct Node
+	{
+		Node *parent;
+		int row;
+		JsonStructureIndex::Member member;
+		QVector<Node *> children;
+	};
+
+	Node *nodeFromIndex(const QModelIndex &index) const;
+	Node *childNode(Node *parent, int row) const;
+	int childCount(const Node *node) const;
+	void deleteChildren(Node *node);
+
+	const JsonStructureIndex *_index;
+	Node *_root;
+};
+
+#endif // JSONOUTLINEMODEL_H
@@ -0,0 +1,289 @@
+/**
+ * @file jsonpositionmap.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsonpositionmap.h"
+#include "jsonstructureindex.h"
+#include <algorithm>
+
+#define SAMPLE_INTERVAL		256
+
+static inline bool isWhitespace(QChar c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+JsonPositionMap::JsonPositionMap()
+{
+}
+
+void JsonPositionMap::clear()
+{
+	_samples.clear();
+}
+
+qint64 JsonPositionMap::memoryUsage() const
+{
+	return qint64(_samples.capacity()) * sizeof(Sample);
+}
+
+void JsonPositionMap::build(const QString &unformatted, const QString &formatted)
+{
+	clear();
+	append(0, 0, unformatted, formatted);
+}
+
+void JsonPositionMap::append(int unformattedFrom, int formattedFrom, const QString &unformatted, const QString &formatted)
+{
+	Walker walker = { unformattedFrom, formattedFrom, false, false };
+	addSample(walker, 0);
+
+	int lastSample = walker.unformatted;
+	while (walker.unformatted < unformatted.length() && walker.formatted < formatted.length())
+	{
+		// Folded sections are replaced by an ellipses in the formatted text.
+		if (!walker.insideString && unformatted.at(walker.unformatted) == HIDDEN_CHAR && !isWhitespace(formatted.at(walker.formatted)))
+		{
+			addSample(walker, HiddenStart);
+
+			walker.unformatted = skipHiddenSection(walker.unformatted, unformatted);
+			if (formatted.mid(walker.formatted, 3) == ELLIPSES)
+			{
+				walker.formatted += 3;
+			}
+
+			addSample(walker, 0);
+			lastSample = walker.unformatted;
+			continue;
+		}
+
+		// Shortened strings go on with ELLIPSES and their size where the rest of the string was.
+		if (walker.insideString && !walker.escaped && formatted.at(walker.formatted) == ELLIPSES_CHAR && unformatted.at(walker.unformatted) != ELLIPSES_CHAR)
+		{
+			int closingQuote = formatted.indexOf('"', walker.formatted);
+			if (closingQuote != -1)
+			{
+				addSample(walker, InsideString | TruncatedStart);
+
+				walker.unformatted = stringEnd(walker.unformatted, unformatted);
+				walker.formatted = closingQuote;
+
+				addSample(walker, InsideString);
+				lastSample = walker.unformatted;
+				continue;
+			}
+		}
+
+		step(walker, unformatted, formatted);
+
+		if (walker.unformatted - lastSample >= SAMPLE_INTERVAL)
+		{
+			addSample(walker, (walker.insideString ? InsideString : 0) | (walker.escaped ? Escaped : 0));
+			lastSample = walker.unformatted;
+		}
+	}
+}
+
+int JsonPositionMap::toFormatted(int position, const QString &unformatted, const QString &formatted) const
+{
+	if (_samples.isEmpty() || position <= 0)
+	{
+		return 0;
+	}
+	if (position >= unformatted.length())
+	{
+		return formatted.length();
+	}
+
+	QVector<Sample>::const_iterator it = std::upper_bound(_samples.constBegin(), _samples.constEnd(), position,
+														   [](int value, const Sample &sample) { return value < sample.unformatted; });
+	int sample = int(it - _samples.constBegin()) - 1;
+
+	// Anything inside a folded section or the hidden end of a string maps onto its ellipses.
+	if ((_samples.at(sample).flags & Elided) && sample + 1 < _samples.count())
+	{
+		return _samples.at(sample).formatted;
+	}
+
+	Walker walker = walkerAt(sample);
+	while (walker.unformatted < position && step(walker, unformatted, formatted))
+	{
+	}
+
+	// Land on the next token rather than on the whitespace before it.
+	if (!walker.insideString && walker.unformatted < unformatted.length() && !isWhitespace(unformatted.at(walker.unformatted)))
+	{
+		while (walker.formatted < formatted.length() && isWhitespace(formatted.at(walker.formatted)))
+		{
+			walker.formatted++;
+		}
+	}
+	return walker.formatted;
+}
+
+int JsonPositionMap::toUnformatted(int position, const QString &unformatted, const QString &formatted) const
+{
+	if (_samples.isEmpty() || position <= 0)
+	{
+		return 0;
+	}
+	if (position >= formatted.length())
+	{
+		return unformatted.length();
+	}
+
+	QVector<Sample>::const_iterator it = std::upper_bound(_samples.constBegin(), _samples.constEnd(), position,
+														   [](int value, const Sample &sample) { return value < sample.formatted; });
+	int sample = int(it - _samples.constBegin()) - 1;
+
+	if ((_samples.at(sample).flags & Elided) && sample + 1 < _samples.count() && position < _samples.at(sample + 1).formatted)
+	{
+		return _samples.at(sample).unformatted;
+	}
+
+	Walker walker = walkerAt(sample);
+	while (walker.formatted < position && step(walker, unformatted, formatted))
+	{
+	}
+
+	if (!walker.insideString && walker.formatted < formatted.length() && !isWhitespace(formatted.at(walker.formatted)))
+	{
+		while (walker.unformatted < unformatted.length() && isWhitespace(unformatted.at(walker.unformatted)))
+		{
+			walker.unformatted++;
+		}
+	}
+	return walker.unformatted;
+}
+
+QVector<JsonPositionMap::Truncation> JsonPositionMap::truncations(int formattedFrom, int formattedTo) const
+{
+	QVector<Truncation> found;
+
+	// Start from the sample before the range, as a truncation can begin before it and reach into it.
+	QVector<Sample>::const_iterator it = std::upper_bound(_samples.constBegin(), _samples.constEnd(), formattedFrom,
+														   [](int value, const Sample &sample) { return value < sample.formatted; });
+	for (int i = qMax(0, int(it - _samples.constBegin()) - 1); i + 1 < _samples.count() && _samples.at(i).formatted < formattedTo; i++)
+	{
+		const Sample &start = _samples.at(i);
+		const Sample &end = _samples.at(i + 1);
+		if ((start.flags & TruncatedStart) && end.formatted > formattedFrom)
+		{
+			Truncation truncation = { start.unformatted, end.unformatted, start.formatted, end.formatted };
+			found.append(truncation);
+		}
+	}
+	return found;
+}
+
+void JsonPositionMap::addSample(const Walker &walker, int flags)
+{
+	Sample sample = { walker.unformatted, walker.formatted, flags };
+	_samples.append(sample);
+}
+
+JsonPositionMap::Walker JsonPositionMap::walkerAt(int sample) const
+{
+	const Sample &s = _samples.at(sample);
+	Walker walker = { s.unformatted, s.formatted, (s.flags & InsideString) != 0, (s.flags & Escaped) != 0 };
+	return walker;
+}
+
+bool JsonPositionMap::step(Walker &walker, const QString &unformatted, const QString &formatted)
+{
+	if (walker.unformatted >= unformatted.length() || walker.formatted >= formatted.length())
+	{
+		return false;
+	}
+
+	QChar unformattedChar = unformatted.at(walker.unformatted);
+	QChar formattedChar = formatted.at(walker.formatted);
+
+	if (!walker.insideString)
+	{
+		if (isWhitespace(unformattedChar))
+		{
+			walker.unformatted++;
+			return true;
+		}
+		if (isWhitespace(formattedChar))
+		{
+			walker.formatted++;
+			return true;
+		}
+	}
+
+	if (unformattedChar != formattedChar)
+	{
+		// Characters dropped by the formatter only exist on the unformatted side.
+		walker.unformatted++;
+		return true;
+	}
+
+	if (walker.escaped)
+	{
+		walker.escaped = false;
+	}
+	else if (unformattedChar == '"')
+	{
+		walker.insideString = !walker.insideString;
+	}
+	else if (walker.insideString && unformattedChar == '\\')
+	{
+		walker.escaped = true;
+	}
+
+	walker.unformatted++;
+	walker.formatted++;
+	return true;
+}
+
+int JsonPositionMap::skipHiddenSection(int position, const QString &unformatted)
+{
+	int depth = 0;
+	for (int i = position; i < unformatted.length(); i++)
+	{
+		if (unformatted.at(i) != HIDDEN_CHAR)
+		{
+			continue;
+		}
+
+		// A closing marker sits directly before the closing brace; any other marker opens a nested section.
+		int next = i + 1;
+		while (next < unformatted.length() && isWhitespace(unformatted.at(next)))
+		{
+			next++;
+		}
+		if (next < unformatted.length() && (unformatted.at(next) == '}' || unformatted.at(next) == ']'))
+		{
+			if (--depth == 0)
+			{
+				return i + 1;
+			}
+		}
+		else
+		{
+			depth++;
+		}
+	}
+	return unformatted.length();
+}
+
+int JsonPositionMap::stringEnd(int position, const QString &unformatted)
+{
+	for (int i = position; i < unformatted.length(); i++)
+	{
+		if (unformatted.at(i) == '\\')
+		{
+			i++;
+		}
+		else if (unformatted.at(i) == '"')
+		{
+			return i;
+		}
+	}
+	return unformatted.length();
+}
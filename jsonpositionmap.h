@@ -0,0 +1,83 @@
+/**
+ * @file jsonpositionmap.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Maps cursor positions between the unformatted and formatted texts.
+ */
+#ifndef JSONPOSITIONMAP_H
+#define JSONPOSITIONMAP_H
+
+#include <QString>
+#include <QVector>
+
+/**
+ * Both texts contain the same tokens in the same order and differ only in whitespace,
+ * folded sections and the hidden ends of shortened strings, so they can be walked in
+ * lockstep.  The walk is done once when the
+ * document is formatted and a sample is kept every few hundred characters; a lookup is a
+ * binary search for the closest sample followed by a short walk from there.
+ *
+ * The texts themselves are owned by the editor and passed in with every call.
+ */
+class JsonPositionMap
+{
+public:
+	/// A string shortened by the formatter, from where it was cut up to its closing quote.
+	struct Truncation
+	{
+		int unformattedStart;
+		int unformattedEnd;
+		int formattedStart;
+		int formattedEnd;
+	};
+
+	JsonPositionMap();
+
+	void clear();
+	qint64 memoryUsage() const;
+	void build(const QString &unformatted, const QString &formatted);
+	void append(int unformattedFrom, int formattedFrom, const QString &unformatted, const QString &formatted);
+
+	int toFormatted(int position, const QString &unformatted, const QString &formatted) const;
+	int toUnformatted(int position, const QString &unformatted, const QString &formatted) const;
+
+	QVector<Truncation> truncations(int formattedFrom, int formattedTo) const;
+
+private:
+	enum SampleFlags
+	{
+		InsideString = 0x1,
+		Escaped = 0x2,
+		HiddenStart = 0x4,
+		TruncatedStart = 0x8,
+
+		Elided = HiddenStart | TruncatedStart
+	};
+
+	struct Sample
+	{
+		int unformatted;
+		int formatted;
+		int flags;
+	};
+
+	struct Walker
+	{
+		int unformatted;
+		int formatted;
+		bool insideString;
+		bool escaped;
+	};
+
+	void addSample(const Walker &walker, int flags);
+	Walker walkerAt(int sample) const;
+
+	static bool step(Walker &walker, const QString &unformatted, const QString &formatted);
+	static int skipHiddenSection(int position, const QString &unformatted);
+	static int stringEnd(int position, const QString &unformatted);
+
+	QVector<Sample> _samples;
+};
+
+#endif // JSONPOSITIONMAP_H
@@ -0,0 +1,765 @@
+/**
+ * @file jsonquery.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsonquery.h"
+#include "jsonworkerpool.h"
+#include <QDateTime>
+#include <algorithm>
+#include <climits>
+
+// Members are read in blocks of this many, each block starting from a checkpoint.
+#define QUERY_BLOCK_MEMBERS					1024
+#define PARALLEL_QUERY_MIN_MEMBERS			(16 * 1024)
+#define PARALLEL_QUERY_CHUNKS_PER_THREAD	4
+
+static inline int sliceBound(int bound, int count)
+{
+	return bound < 0 ? qMax(0, count + bound) : qMin(bound, count);
+}
+
+JsonQuery::JsonQuery()
+{
+}
+
+bool JsonQuery::compile(const QString &expression)
+{
+	_steps.clear();
+	_error.clear();
+
+	QString text = expression;
+	while (!text.isEmpty() && text.at(text.length() - 1).isSpace())
+	{
+		text.chop(1);
+	}
+
+	int position = 0;
+	skipSpaces(text, position);
+	bool rooted = position < text.length() && text.at(position) == '$';
+	if (rooted)
+	{
+		position++;
+	}
+	else if (text.midRef(position) == ".")
+	{
+		// jq's identity, the whole document.
+		return true;
+	}
+
+	int start = position;
+	while (position < text.length())
+	{
+		// A bare name at the start is a member of the root, as with Go to Path.
+		bool bareName = !rooted && position == start;
+		if (!parseSegment(text, position, bareName))
+		{
+			_steps.clear();
+			return false;
+		}
+	}
+	return true;
+}
+
+QString JsonQuery::errorString() const
+{
+	return _error;
+}
+
+bool JsonQuery::parseSegment(const QString &text, int &position, bool bareName)
+{
+	Step step;
+	step.selector = Key;
+	step.recursive = false;
+	step.index = -1;
+	step.sliceEnd = 0;
+
+	if (text.midRef(position, 2) == "..")
+	{
+		step.recursive = true;
+		position += 2;
+	}
+	else if (text.at(position) == '.')
+	{
+		position++;
+	}
+	else if (text.at(position) != '[' && !bareName)
+	{
+		return fail("Expected '.' or '['", position);
+	}
+
+	if (position < text.length() && text.at(position) == '[')
+	{
+		if (!parseBracket(text, position, step))
+		{
+			return false;
+		}
+	}
+	else if (position < text.length() && text.at(position) == '*')
+	{
+		step.selector = Wildcard;
+		position++;
+	}
+	else
+	{
+		int start = position;
+		while (position < text.length() && text.at(position) != '.' && text.at(position) != '[')
+		{
+			position++;
+		}
+		if (position == start)
+		{
+			return fail("Expected a member name", position);
+		}
+
+		// Numeric names also pick array elements, as with Go to Path.
+		bool isNumber;
+		step.key = text.mid(start, position - start);
+		step.index = step.key.toInt(&isNumber);
+		if (!isNumber || step.index < 0)
+		{
+			step.index = -1;
+		}
+	}
+
+	_steps.append(step);
+	return true;
+}
+
+bool JsonQuery::parseBracket(const QString &text, int &position, Step &step)
+{
+	position++;
+	skipSpaces(text, position);
+	if (position >= text.length())
+	{
+		return fail("Expected ']'", position);
+	}
+
+	QChar c = text.at(position);
+	if (c == ']')
+	{
+		// jq's .[] takes every member.
+		step.selector = Wildcard;
+	}
+	else if (c == '*')
+	{
+		step.selector = Wildcard;
+		position++;
+	}
+	else if (c == '\'' || c == '"')
+	{
+		step.selector = Key;
+		if (!parseQuoted(text, position, step.key))
+		{
+			return fail("Unterminated name", position);
+		}
+	}
+	else if (c == '?')
+	{
+		step.selector = Filter;
+		position++;
+		if (!parseFilter(text, position, step))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		// An index, or a slice with either bound left out.
+		int start = 0;
+		bool hasStart = parseInteger(text, position, start);
+		skipSpaces(text, position);
+		if (position < text.length() && text.at(position) == ':')
+		{
+			position++;
+			skipSpaces(text, position);
+			step.selector = Slice;
+			step.index = hasStart ? start : 0;
+			if (!parseInteger(text, position, step.sliceEnd))
+			{
+				step.sliceEnd = INT_MAX;
+			}
+		}
+		else if (hasStart)
+		{
+			step.selector = Index;
+			step.index = start;
+		}
+		else
+		{
+			return fail("Expected an index, a quoted name, '*' or a filter", position);
+		}
+	}
+
+	skipSpaces(text, position);
+	if (position >= text.length() || text.at(position) != ']')
+	{
+		return fail("Expected ']'", position);
+	}
+	position++;
+	return true;
+}
+
+bool JsonQuery::parseFilter(const QString &text, int &position, Step &step)
+{
+	skipSpaces(text, position);
+	bool parenthesised = position < text.length() && text.at(position) == '(';
+	if (parenthesised)
+	{
+		position++;
+	}
+
+	// && binds tighter than ||, so the filter is a list of alternatives.
+	step.filter.append(QVector<Comparison>());
+	while (true)
+	{
+		Comparison comparison;
+		if (!parseComparison(text, position, comparison))
+		{
+			return false;
+		}
+		step.filter.last().append(comparison);
+
+		skipSpaces(text, position);
+		QStringRef next = text.midRef(position, 2);
+		if (next == "&&")
+		{
+			position += 2;
+		}
+		else if (next == "||")
+		{
+			position += 2;
+			step.filter.append(QVector<Comparison>());
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if (parenthesised)
+	{
+		if (position >= text.length() || text.at(position) != ')')
+		{
+			return fail("Expected ')'", position);
+		}
+		position++;
+	}
+	return true;
+}
+
+bool JsonQuery::parseComparison(const QString &text, int &position, Comparison &comparison)
+{
+	skipSpaces(text, position);
+	if (position >= text.length() || text.at(position) != '@')
+	{
+		return fail("Expected '@'", position);
+	}
+	position++;
+
+	while (position < text.length() && (text.at(position) == '.' || text.at(position) == '['))
+	{
+		Token token;
+		token.index = -1;
+		token.isIndex = false;
+
+		if (text.at(position) == '.')
+		{
+			position++;
+			int start = position;
+			while (position < text.length() && (text.at(position).isLetterOrNumber() || text.at(position) == '_' || text.at(position) == '$'))
+			{
+				position++;
+			}
+			if (position == start)
+			{
+				return fail("Expected a member name", position);
+			}
+
+			token.key = text.mid(start, position - start);
+			token.index = token.key.toInt(&token.isIndex);
+			token.isIndex = token.isIndex && token.index >= 0;
+		}
+		else
+		{
+			position++;
+			skipSpaces(text, position);
+			if (position < text.length() && (text.at(position) == '\'' || text.at(position) == '"'))
+			{
+				if (!parseQuoted(text, position, token.key))
+				{
+					return fail("Unterminated name", position);
+				}
+			}
+			else if (parseInteger(text, position, token.index))
+			{
+				token.key = QString::number(token.index);
+				token.isIndex = true;
+			}
+			else
+			{
+				return fail("Expected an index or a quoted name", position);
+			}
+
+			skipSpaces(text, position);
+			if (position >= text.length() || text.at(position) != ']')
+			{
+				return fail("Expected ']'", position);
+			}
+			position++;
+		}
+
+		comparison.path.append(token);
+	}
+
+	static const struct
+	{
+		const char *text;
+		Operator op;
+	} operators[] =
+	{
+		{ "==", Equal },
+		{ "!=", NotEqual },
+		{ "<=", LessOrEqual },
+		{ ">=", GreaterOrEqual },
+		{ "<", Less },
+		{ ">", Greater }
+	};
+
+	skipSpaces(text, position);
+	comparison.op = Exists;
+	comparison.type = Keyword;
+	comparison.number = 0;
+	for (unsigned i = 0; i < sizeof(operators) / sizeof(operators[0]); i++)
+	{
+		int length = int(qstrlen(operators[i].text));
+		if (text.midRef(position, length) == QLatin1String(operators[i].text))
+		{
+			comparison.op = operators[i].op;
+			position += length;
+			break;
+		}
+	}
+
+	// A path on its own only tests that the member exists.
+	if (comparison.op == Exists)
+	{
+		return true;
+	}
+
+	skipSpaces(text, position);
+	return parseLiteral(text, position, comparison);
+}
+
+bool JsonQuery::parseLiteral(const QString &text, int &position, Comparison &comparison)
+{
+	if (position < text.length() && (text.at(position) == '\'' || text.at(position) == '"'))
+	{
+		comparison.type = String;
+		if (!parseQuoted(text, position, comparison.text))
+		{
+			return fail("Unterminated string", position);
+		}
+		return true;
+	}
+
+	int start = position;
+	while (position < text.length() && (text.at(position).isLetterOrNumber() || text.at(position) == '-' ||
+										text.at(position) == '+' || text.at(position) == '.'))
+	{
+		position++;
+	}
+
+	comparison.text = text.mid(start, position - start);
+	if (comparison.text == QLatin1String("true") || comparison.text == QLatin1String("false") || comparison.text == QLatin1String("null"))
+	{
+		comparison.type = Keyword;
+		return true;
+	}
+
+	bool isNumber;
+	comparison.number = comparison.text.toDouble(&isNumber);
+	if (!isNumber)
+	{
+		return fail("Expected a string, a number, true, false or null", start);
+	}
+	comparison.type = Number;
+	return true;
+}
+
+bool JsonQuery::fail(const QString &message, int position)
+{
+	_error = QString("%1 at column %2.").arg(message).arg(position + 1);
+	return false;
+}
+
+bool JsonQuery::parseInteger(const QString &text, int &position, int &value)
+{
+	int end = position;
+	if (end < text.length() && text.at(end) == '-')
+	{
+		end++;
+	}
+
+	int digits = end;
+	while (end < text.length() && text.at(end).isDigit())
+	{
+		end++;
+	}
+	if (end == digits)
+	{
+		return false;
+	}
+
+	bool isNumber;
+	value = text.midRef(position, end - position).toInt(&isNumber);
+	if (!isNumber)
+	{
+		return false;
+	}
+	position = end;
+	return true;
+}
+
+bool JsonQuery::parseQuoted(const QString &text, int &position, QString &value)
+{
+	QChar quote = text.at(position++);
+	while (position < text.length() && text.at(position) != quote)
+	{
+		if (text.at(position) == '\\' && position + 1 < text.length())
+		{
+			position++;
+		}
+		value += text.at(position++);
+	}
+
+	if (position >= text.length())
+	{
+		return false;
+	}
+	position++;
+	return true;
+}
+
+void JsonQuery::skipSpaces(const QString &text, int &position)
+{
+	while (position < text.length() && text.at(position).isSpace())
+	{
+		position++;
+	}
+}
+
+QVector<JsonQuery::Match> JsonQuery::evaluate(const JsonStructureIndex &index) const
+{
+	qint64 timeStart = QDateTime::currentMSecsSinceEpoch();
+
+	QVector<Match> matches;
+	int roots = index.rootCount();
+	if (roots == 1)
+	{
+		evaluateValue(index, 0, index.member(-1, 0), matches, true);
+	}
+	else if (_steps.isEmpty())
+	{
+		for (int i = 0; i < roots; i++)
+		{
+			matches.append(matchFor(index.member(-1, i)));
+		}
+	}
+	else if (roots > 0)
+	{
+		// Several top-level values are queried as the elements of one array.
+		if (_steps.first().recursive)
+		{
+			descend(index, 0, -1, matches, true);
+		}
+		else
+		{
+			select(index, 0, -1, matches, true);
+		}
+	}
+
+	// Recursive descent can reach a member more than once, and out of document order.
+	std::sort(matches.begin(), matches.end(), [](const Match &a, const Match &b) { return a.offset < b.offset; });
+	matches.erase(std::unique(matches.begin(), matches.end(), [](const Match &a, const Match &b) { return a.offset == b.offset; }), matches.end());
+
+	qDebug("time to run query: %lld ms (%d matches)", QDateTime::currentMSecsSinceEpoch() - timeStart, matches.count());
+	return matches;
+}
+
+void JsonQuery::evaluateValue(const JsonStructureIndex &index, int step, const JsonStructureIndex::Member &value,
+							  QVector<Match> &matches, bool topLevel) const
+{
+	if (step == _steps.count())
+	{
+		matches.append(matchFor(value));
+		return;
+	}
+
+	// Scalars have no members to select from.
+	if (value.container == -1)
+	{
+		return;
+	}
+
+	if (_steps.at(step).recursive)
+	{
+		descend(index, step, value.container, matches, topLevel);
+	}
+	else
+	{
+		select(index, step, value.container, matches, topLevel);
+	}
+}
+
+void JsonQuery::select(const JsonStructureIndex &index, int step, int container, QVector<Match> &matches, bool topLevel) const
+{
+	const Step &s = _steps.at(step);
+	bool isArray = container == -1 || index.container(container).isArray;
+	int count = index.memberCount(container);
+
+	if (s.selector == Key || s.selector == Index)
+	{
+		JsonStructureIndex::Member member;
+		if (isArray)
+		{
+			if (s.index < 0 && s.selector == Key)
+			{
+				return;
+			}
+			member = index.member(container, s.index < 0 ? count + s.index : s.index);
+		}
+		else if (s.selector == Key)
+		{
+			member = index.findMember(container, s.key);
+		}
+		else
+		{
+			return;
+		}
+
+		if (member.index != -1)
+		{
+			evaluateValue(index, step + 1, member, matches, false);
+		}
+		return;
+	}
+
+	int from = 0;
+	int to = count;
+	if (s.selector == Slice)
+	{
+		if (!isArray)
+		{
+			return;
+		}
+		from = sliceBound(s.index, count);
+		to = sliceBound(s.sliceEnd, count);
+	}
+
+	evaluateRange(from, to, topLevel, [this, &index, step, container](int first, int last, QVector<Match> &found)
+	{
+		const Step &s = _steps.at(step);
+		for (int block = first; block < last; block += QUERY_BLOCK_MEMBERS)
+		{
+			QVector<JsonStructureIndex::Member> members = index.members(container, block, qMin(QUERY_BLOCK_MEMBERS, last - block));
+			for (int i = 0; i < members.count(); i++)
+			{
+				// Filters are tested before anything below the member is read.
+				if (s.selector == Filter && !passesFilter(index, s, members.at(i)))
+				{
+					continue;
+				}
+				evaluateValue(index, step + 1, members.at(i), found, false);
+			}
+		}
+	}, matches);
+}
+
+void JsonQuery::descend(const JsonStructureIndex &index, int step, int container, QVector<Match> &matches, bool topLevel) const
+{
+	// Containers are stored in document order, so the descendants of one directly follow it
+	// and every scalar in between is skipped without being read.
+	int first = 0;
+	int last = index.containerCount();
+	if (container == -1)
+	{
+		select(index, step, -1, matches, false);
+	}
+	else
+	{
+		int end = index.containerEnd(container);
+		int low = container + 1;
+		int high = last;
+		while (low < high)
+		{
+			int middle = (low + high) / 2;
+			if (index.container(middle).start <= end)
+			{
+				low = middle + 1;
+			}
+			else
+			{
+				high = middle;
+			}
+		}
+		first = container;
+		last = low;
+	}
+
+	evaluateRange(first, last, topLevel, [this, &index, step](int from, int to, QVector<Match> &found)
+	{
+		for (int i = from; i < to; i++)
+		{
+			select(index, step, i, found, false);
+		}
+	}, matches);
+}
+
+bool JsonQuery::passesFilter(const JsonStructureIndex &index, const Step &step, const JsonStructureIndex::Member &member) const
+{
+	for (int i = 0; i < step.filter.count(); i++)
+	{
+		const QVector<Comparison> &comparisons = step.filter.at(i);
+		int passed = 0;
+		while (passed < comparisons.count() && compare(index, comparisons.at(passed), member))
+		{
+			passed++;
+		}
+		if (passed == comparisons.count())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool JsonQuery::compare(const JsonStructureIndex &index, const Comparison &comparison, const JsonStructureIndex::Member &member) const
+{
+	// Follow the path from the member, reading only the keys of the containers on the way.
+	JsonStructureIndex::Member value = member;
+	for (int i = 0; i < comparison.path.count(); i++)
+	{
+		if (value.container == -1)
+		{
+			return false;
+		}
+
+		const Token &token = comparison.path.at(i);
+		if (index.container(value.container).isArray)
+		{
+			if (!token.isIndex)
+			{
+				return false;
+			}
+			value = index.member(value.container, token.index < 0 ? index.memberCount(value.container) + token.index : token.index);
+		}
+		else
+		{
+			value = index.findMember(value.container, token.key);
+		}
+
+		if (value.index == -1)
+		{
+			return false;
+		}
+	}
+
+	if (comparison.op == Exists)
+	{
+		return true;
+	}
+
+	// The value is compared as it appears in the text; strings are only unescaped if they have to be.
+	QStringRef raw = index.text().midRef(value.valueStart, value.valueEnd - value.valueStart + 1);
+	QChar first = raw.isEmpty() ? QChar() : raw.at(0);
+	int order;
+	if (comparison.type == String && first == '"')
+	{
+		QStringRef content = raw.mid(1, raw.length() - 2);
+		order = content.contains('\\') ? QString::compare(JsonStructureIndex::unescapedString(content), comparison.text) : QStringRef::compare(content, comparison.text);
+	}
+	else if (comparison.type == Number && (first == '-' || first.isDigit()))
+	{
+		bool isNumber;
+		double number = raw.toDouble(&isNumber);
+		if (!isNumber)
+		{
+			return comparison.op == NotEqual;
+		}
+		order = number < comparison.number ? -1 : (number > comparison.number ? 1 : 0);
+	}
+	else if (comparison.type == Keyword && raw == comparison.text)
+	{
+		// true, false and null only equal themselves.
+		return comparison.op == Equal || comparison.op == LessOrEqual || comparison.op == GreaterOrEqual;
+	}
+	else
+	{
+		// Values of different types are never equal, and have no order.
+		return comparison.op == NotEqual;
+	}
+
+	switch (comparison.op)
+	{
+		case Equal:
+			return order == 0;
+		case NotEqual:
+			return order != 0;
+		case Less:
+			return order < 0;
+		case LessOrEqual:
+			return order <= 0;
+		case Greater:
+			return order > 0;
+		case GreaterOrEqual:
+			return order >= 0;
+		default:
+			return true;
+	}
+}
+
+void JsonQuery::evaluateRange(int from, int to, bool parallel, const RangeEvaluator &evaluator, QVector<Match> &matches)
+{
+	int workers = JsonWorkerPool::instance().workerCount() + 1;
+	if (!parallel || to - from < PARALLEL_QUERY_MIN_MEMBERS || workers < 2)
+	{
+		evaluator(from, to, matches);
+		return;
+	}
+
+	// A few chunks per thread so that a handful of large elements don't leave the other threads
+	// idle, each a whole number of blocks so no checkpoint is read twice.
+	int chunkSize = qMax(QUERY_BLOCK_MEMBERS, (to - from) / (workers * PARALLEL_QUERY_CHUNKS_PER_THREAD));
+	chunkSize = (chunkSize + QUERY_BLOCK_MEMBERS - 1) / QUERY_BLOCK_MEMBERS * QUERY_BLOCK_MEMBERS;
+
+	// Tasks write through a pointer taken beforehand, as calling the non-const operator[] from several threads isn't safe.
+	QVector<QVector<Match> > chunks((to - from + chunkSize - 1) / chunkSize);
+	QVector<Match> *results = chunks.data();
+	QVector<JsonWorkerPool::Task> tasks;
+	for (int i = 0; i < chunks.count(); i++)
+	{
+		tasks.append([&evaluator, results, from, to, chunkSize, i]()
+		{
+			int first = from + i * chunkSize;
+			evaluator(first, qMin(first + chunkSize, to), results[i]);
+		});
+	}
+	JsonWorkerPool::instance().run(tasks);
+
+	for (int i = 0; i < chunks.count(); i++)
+	{
+		matches += chunks.at(i);
+	}
+}
+
+JsonQuery::Match JsonQuery::matchFor(const JsonStructureIndex::Member &member)
+{
+	Match match;
+	match.offset = member.keyStart != -1 ? member.keyStart : member.valueStart;
+	match.valueStart = member.valueStart;
+	match.valueEnd = member.valueEnd;
+	return match;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file jsonquery.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief JSONPath queries evaluated directly against a structure index.
+ */
+#ifndef JSONQUERY_H
+#define JSONQUERY_H
+
+#include <QString>
+#include <QVector>
+#include <functional>
+#include "jsonstructureindex.h"
+
+/**
+ * Evaluates a subset of JSONPath over the raw text and its structure index, without
+ * building a tree.  Supported are child names ($.a, $['a']), indexes and slices ([2],
+ * [-1], [1:5]), wildcards (.*, [*] and jq's []), recursive descent (..a) and filters
+ * ([?(@.price < 10 && @.tags)]) comparing against strings, numbers, true, false or null.
+ *
+ * Only the members named by the query are ever read; every other subtree is stepped over
+ * by jumping to its end offset.  Filters are tested while the members are scanned, on the
+ * raw text of the values they compare, so elements that fail are never descended into.
+ * With a large top-level array, or many top-level values, the elements are split across
+ * the worker pool.
+ */
+class JsonQuery
+{
+public:
+	struct Match
+	{
+		int offset;				///< Offset of the member key, or of the value for array elements.
+		int valueStart;
+		int valueEnd;			///< Offset of the last character of the value.
+	};
+
+	JsonQuery();
+
+	bool compile(const QString &expression);
+	QString errorString() const;
+
+	QVector<Match> evaluate(const JsonStructureIndex &index) const;
+
+private:
+	enum Selector
+	{
+		Key,
+		Index,
+		Slice,
+		Wildcard,
+		Filter
+	};
+
+	enum Operator
+	{
+		Exists,
+		Equal,
+		NotEqual,
+		Less,
+		LessOrEqual,
+		Greater,
+		GreaterOrEqual
+	};
+
+	enum LiteralType
+	{
+		String,
+		Number,
+		Keyword					///< true, false or null, compared by their text.
+	};
+
+	struct Token
+	{
+		QString key;
+		int index;				///< Array index, counted from the end when negative.
+		bool isIndex;			///< Whether the token can select an array element.
+	};
+
+	struct Comparison
+	{
+		QVector<Token> path;	///< Path from the member being tested, after the @.
+		Operator op;
+		LiteralType type;
+		QString text;
+		double number;
+	};
+
+	struct Step
+	{
+		Selector selector;
+		bool recursive;			///< Whether the selector applies to every descendant, as with ..
+		QString key;
+		int index;				///< Array index, or the start of a slice.
+		int sliceEnd;
+		QVector<QVector<Comparison> > filter;	///< Alternatives joined by ||, each of comparisons joined by &&.
+	};
+
+	typedef std::function<void(int from, int to, QVector<Match> &matches)> RangeEvaluator;
+
+	bool parseSegment(const QString &text, int &position, bool bareName);
+	bool parseBracket(const QString &text, int &position, Step &step);
+	bool parseFilter(const QString &text, int &position, Step &step);
+	bool parseComparison(const QString &text, int &position, Comparison &comparison);
+	bool parseLiteral(const QString &text, int &position, Comparison &comparison);
+	bool fail(const QString &message, int position);
+
+	static bool parseInteger(const QString &text, int &position, int &value);
+	static bool parseQuoted(const QString &text, int &position, QString &value);
+	static void skipSpaces(const QString &text, int &position);
+
+	void evaluateValue(const JsonStructureIndex &index, int step, const JsonStructureIndex::Member &value,
+					   QVector<Match> &matches, bool topLevel) const;
+	void select(const JsonStructureIndex &index, int step, int container, QVector<Match> &matches, bool topLevel) const;
+	void descend(const JsonStructureIndex &index, int step, int container, QVector<Match> &matches, bool topLevel) const;
+	bool passesFilter(const JsonStructureIndex &index, const Step &step, const JsonStructureIndex::Member &member) const;
+	bool compare(const JsonStructureIndex &index, const Comparison &comparison, const JsonStructureIndex::Member &member) const;
+
+	static void evaluateRange(int from, int to, bool parallel, const RangeEvaluator &evaluator, QVector<Match> &matches);
+	static Match matchFor(const JsonStructureIndex::Member &member);
+
+	QVector<Step> _steps;
+	QString _error;
+};
+
+#endif // JSONQUERY_H
@@ -0,0 +1,73 @@
+/**
+ * @file jsonstartuptrace.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsonstartuptrace.h"
+#include <QWidget>
+#include <QEvent>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QSet>
+#include <QByteArray>
+
+static QElapsedTimer startupTimer;
+static QSet<QByteArray> markedEvents;
+
+void JsonStartupTrace::start()
+{
+	startupTimer.start();
+}
+
+void JsonStartupTrace::mark(const char *event, qint64 budget)
+{
+	if (!startupTimer.isValid() || markedEvents.contains(event))
+	{
+		return;
+	}
+	markedEvents.insert(event);
+
+	qint64 elapsed = startupTimer.elapsed();
+	qDebug("time to %s: %lld ms", event, elapsed);
+	if (budget > 0 && elapsed > budget)
+	{
+		qWarning("time to %s is over its budget of %lld ms", event, budget);
+	}
+}
+
+void JsonStartupTrace::markOnPaint(QWidget *widget, const char *event, qint64 budget)
+{
+	if (!startupTimer.isValid() || markedEvents.contains(event))
+	{
+		return;
+	}
+
+	// Deletes itself once the widget has been painted.
+	new JsonStartupTrace(widget, event, budget);
+}
+
+JsonStartupTrace::JsonStartupTrace(QWidget *widget, const char *event, qint64 budget) :
+	QObject(widget),
+	_event(event),
+	_budget(budget)
+{
+	widget->installEventFilter(this);
+	widget->update();
+}
+
+bool JsonStartupTrace::eventFilter(QObject *object, QEvent *event)
+{
+	if (event->type() == QEvent::Paint)
+	{
+		// The event is only on its way to the widget, so the time is taken once it has been painted.
+		object->removeEventFilter(this);
+		QTimer::singleShot(0, this, [this]()
+		{
+			mark(_event, _budget);
+			deleteLater();
+		});
+	}
+	return QObject::eventFilter(object, event);
+}
@@ -0,0 +1,39 @@
+/**
+ * @file jsonstartuptrace.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Times from launch to the first frame, the first content and the first formatted view.
+ */
+#ifndef JSONSTARTUPTRACE_H
+#define JSONSTARTUPTRACE_H
+
+#include <QObject>
+
+class QWidget;
+
+/**
+ * Every event is logged once, the first time it happens, as the time since start().
+ * Events tied to painting are logged when the widget is next painted, which is when
+ * whatever it shows is actually on screen.
+ */
+class JsonStartupTrace : public QObject
+{
+	Q_OBJECT
+
+public:
+	static void start();
+	static void mark(const char *event, qint64 budget = 0);
+	static void markOnPaint(QWidget *widget, const char *event, qint64 budget = 0);
+
+protected:
+	bool eventFilter(QObject *object, QEvent *event);
+
+private:
+	JsonStartupTrace(QWidget *widget, const char *event, qint64 budget);
+
+	const char *_event;
+	qint64 _budget;
+};
+
+#endif // JSONSTARTUPTRACE_H
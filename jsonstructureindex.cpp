@@ -0,0 +1,1334 @@
+/**
+ * @file jsonstructureindex.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsonstructureindex.h"
+#include <QRegularExpression>
+#include <QStringList>
+#include <QDataStream>
+#include <QIODevice>
+#include <algorithm>
+
+#define HASH_OFFSET		Q_UINT64_C(0xcbf29ce484222325)
+#define HASH_PRIME		Q_UINT64_C(0x100000001b3)
+#define STRING_SEED		Q_UINT64_C(0x1)
+#define LITERAL_SEED	Q_UINT64_C(0x2)
+#define OBJECT_SEED		Q_UINT64_C(0x9e3779b97f4a7c15)
+#define ARRAY_SEED		Q_UINT64_C(0x632be59bd9b4e019)
+
+static inline int hexDigit(ushort c)
+{
+	if (c >= '0' && c <= '9')
+	{
+		return c - '0';
+	}
+	if (c >= 'a' && c <= 'f')
+	{
+		return c - 'a' + 10;
+	}
+	if (c >= 'A' && c <= 'F')
+	{
+		return c - 'A' + 10;
+	}
+	return -1;
+}
+
+JsonStructureIndex::JsonStructureIndex()
+{
+	clear();
+}
+
+void JsonStructureIndex::clear()
+{
+	_text.clear();
+	_containers.clear();
+	_checkpoints.clear();
+	_roots.clear();
+	_markers.clear();
+	_openContainers.clear();
+	_openCheckpoints.clear();
+	_insideString = false;
+	_escaped = false;
+	_lastStringStart = -1;
+	_lastStringEnd = -1;
+	_pendingKeyStart = -1;
+	_pendingKeyLength = 0;
+	_openHashes.clear();
+	_openKeyHashes.clear();
+	_tokenHash = 0;
+	_pendingKeyHash = 0;
+	_insideLiteral = false;
+	_expectingKey = false;
+	resetKeyTables();
+}
+
+void JsonStructureIndex::build(const QString &text)
+{
+	clear();
+	_text = text;
+	scan(0);
+}
+
+void JsonStructureIndex::append(const QString &text)
+{
+	// The scanner keeps its state between calls, so only the new text is read.
+	int from = _text.length();
+	_text += text;
+	resetKeyTables();
+	scan(from);
+}
+
+int JsonStructureIndex::setFolds(const QBitArray &folds, int position)
+{
+	// Hidden chars go just inside the opening and closing braces of each folded object.
+	QVector<int> inserted;
+	for (int i = 0; i < _containers.count(); i++)
+	{
+		Container &container = _containers[i];
+		container.folded = i < folds.size() && folds.testBit(i) && !container.isArray && container.childCount > 0 && container.end != -1;
+		if (container.folded)
+		{
+			inserted.append(container.start + 1);
+			inserted.append(container.end);
+		}
+	}
+	std::sort(inserted.begin(), inserted.end());
+
+	// Rebuild the text in a single pass, dropping any old markers.
+	const QChar *data = _text.constData();
+	const int length = _text.length();
+	QVector<int> removed;
+	QString folded;
+	folded.reserve(length + inserted.count());
+	_markers.clear();
+
+	int next = 0;
+	for (int i = 0; i <= length; i++)
+	{
+		while (next < inserted.count() && inserted.at(next) == i)
+		{
+			_markers.append(folded.length());
+			folded += QChar(HIDDEN_CHAR);
+			next++;
+		}
+		if (i == length)
+		{
+			break;
+		}
+		if (data[i] == HIDDEN_CHAR)
+		{
+			removed.append(i);
+		}
+		else
+		{
+			folded += data[i];
+		}
+	}
+
+	// Markers don't change the structure, so every offset just moves past the markers before it.
+	auto remap = [&inserted, &removed](int offset)
+	{
+		if (offset < 0)
+		{
+			return offset;
+		}
+		int before = int(std::lower_bound(removed.constBegin(), removed.constEnd(), offset) - removed.constBegin());
+		int after = int(std::upper_bound(inserted.constBegin(), inserted.constEnd(), offset) - inserted.constBegin());
+		return offset - before + after;
+	};
+
+	if (!inserted.isEmpty() || !removed.isEmpty())
+	{
+		for (int i = 0; i < _containers.count(); i++)
+		{
+			Container &container = _containers[i];
+			container.start = remap(container.start);
+			container.end = remap(container.end);
+			container.keyStart = remap(container.keyStart);
+		}
+		for (int i = 0; i < _checkpoints.count(); i++)
+		{
+			_checkpoints[i] = remap(_checkpoints.at(i));
+		}
+		for (int i = 0; i < _roots.count(); i++)
+		{
+			_roots[i] = remap(_roots.at(i));
+		}
+		for (int i = 0; i < _openCheckpoints.count(); i++)
+		{
+			_openCheckpoints[i] = remap(_openCheckpoints.at(i));
+		}
+		_lastStringStart = remap(_lastStringStart);
+		_lastStringEnd = remap(_lastStringEnd);
+		_pendingKeyStart = remap(_pendingKeyStart);
+		position = remap(position);
+	}
+
+	_text = folded;
+	resetKeyTables();
+	return position;
+}
+
+void JsonStructureIndex::save(QDataStream &stream) const
+{
+	stream << qint32(sizeof(Container)) << qint32(_containers.count()) << qint32(_checkpoints.count()) << qint32(_roots.count());
+	stream.writeRawData(reinterpret_cast<const char *>(_containers.constData()), _containers.count() * int(sizeof(Container)));
+	stream.writeRawData(reinterpret_cast<const char *>(_checkpoints.constData()), _checkpoints.count() * int(sizeof(int)));
+	stream.writeRawData(reinterpret_cast<const char *>(_roots.constData()), _roots.count() * int(sizeof(int)));
+}
+
+bool JsonStructureIndex::load(QDataStream &stream, const QString &text)
+{
+	clear();
+
+	qint32 containerSize, containerCount, checkpointCount, rootCount;
+	stream >> containerSize >> containerCount >> checkpointCount >> rootCount;
+	if (stream.status() != QDataStream::Ok || containerSize != qint32(sizeof(Container)) ||
+		containerCount < 0 || checkpointCount < 0 || rootCount < 0)
+	{
+		return false;
+	}
+
+	// The counts have to fit in what is left of the stream before anything is allocated for them.
+	qint64 bytes = qint64(containerCount) * qint64(sizeof(Container)) + (qint64(checkpointCount) + qint64(rootCount)) * qint64(sizeof(int));
+	if (stream.device() == NULL || bytes > stream.device()->bytesAvailable())
+	{
+		return false;
+	}
+
+	_containers.resize(containerCount);
+	_checkpoints.resize(checkpointCount);
+	_roots.resize(rootCount);
+
+	int containerBytes = containerCount * int(sizeof(Container));
+	int checkpointBytes = checkpointCount * int(sizeof(int));
+	int rootBytes = rootCount * int(sizeof(int));
+	if (stream.readRawData(reinterpret_cast<char *>(_containers.data()), containerBytes) != containerBytes ||
+		stream.readRawData(reinterpret_cast<char *>(_checkpoints.data()), checkpointBytes) != checkpointBytes ||
+		stream.readRawData(reinterpret_cast<char *>(_roots.data()), rootBytes) != rootBytes)
+	{
+		clear();
+		return false;
+	}
+
+	// The cache file can be damaged or written by another build, so nothing in it is trusted.
+	if (!isConsistentWith(text))
+	{
+		clear();
+		return false;
+	}
+
+	_text = text;
+	return true;
+}
+
+bool JsonStructureIndex::isConsistentWith(const QString &text) const
+{
+	// Top-level values are in order within the text.
+	for (int i = 0; i < _roots.count(); i++)
+	{
+		int root = _roots.at(i);
+		if (root < 0 || root >= text.length() || (i > 0 && root <= _roots.at(i - 1)))
+		{
+			return false;
+		}
+	}
+
+	// Only complete documents are saved, so every container closes inside the text, in
+	// document order, within its parent and with its checkpoints inside it.
+	int checkpointTotal = 0;
+	for (int i = 0; i < _containers.count(); i++)
+	{
+		// Flags are read back as raw bytes, and anything but 0 or 1 isn't a valid bool.
+		const Container &container = _containers.at(i);
+		if (*reinterpret_cast<const uchar *>(&container.isArray) > 1 || *reinterpret_cast<const uchar *>(&container.folded) > 1)
+		{
+			return false;
+		}
+		if (container.start < 0 || container.end <= container.start || container.end >= text.length() ||
+			text.at(container.start) != (container.isArray ? '[' : '{') || text.at(container.end) != (container.isArray ? ']' : '}') ||
+			(i > 0 && container.start <= _containers.at(i - 1).start) || container.folded || container.childCount < 0)
+		{
+			return false;
+		}
+
+		if (container.parent == -1)
+		{
+			if (container.depth != 0 || container.keyStart != -1 || container.indexInParent < 0 ||
+				container.indexInParent >= _roots.count() || _roots.at(container.indexInParent) != container.start)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			if (container.parent < 0 || container.parent >= i)
+			{
+				return false;
+			}
+			const Container &parent = _containers.at(container.parent);
+			if (container.start <= parent.start || container.end >= parent.end || container.depth != parent.depth + 1 ||
+				container.indexInParent < 0 || container.indexInParent >= parent.childCount)
+			{
+				return false;
+			}
+			if (container.keyStart != -1 && (parent.isArray || container.keyStart <= parent.start || container.keyLength < 2 ||
+											 container.keyStart + container.keyLength > container.start))
+			{
+				return false;
+			}
+		}
+
+		int checkpoints = container.childCount == 0 ? 0 : (container.childCount - 1) / CheckpointStride + 1;
+		if (container.firstCheckpoint < 0 || container.firstCheckpoint > _checkpoints.count() - checkpoints)
+		{
+			return false;
+		}
+		for (int j = 0; j < checkpoints; j++)
+		{
+			int offset = _checkpoints.at(container.firstCheckpoint + j);
+			if (offset <= container.start || offset > container.end ||
+				(j > 0 && offset <= _checkpoints.at(container.firstCheckpoint + j - 1)))
+			{
+				return false;
+			}
+		}
+		checkpointTotal += checkpoints;
+	}
+
+	return checkpointTotal == _checkpoints.count();
+}
+
+const QString &JsonStructureIndex::text() const
+{
+	return _text;
+}
+
+bool JsonStructureIndex::isEmpty() const
+{
+	return _roots.isEmpty();
+}
+
+qint64 JsonStructureIndex::memoryUsage() const
+{
+	qint64 keyTableBytes = 0;
+	_keyTables->mutex.lock();
+	foreach (const QVector<KeyEntry> &table, _keyTables->tables)
+	{
+		keyTableBytes += qint64(table.capacity()) * sizeof(KeyEntry);
+	}
+	_keyTables->mutex.unlock();
+
+	// The text isn't included; it is counted along with the other copies of the raw text.
+	return qint64(_containers.capacity()) * sizeof(Container) +
+		   qint64(_checkpoints.capacity() + _roots.capacity() + _markers.capacity() + _openContainers.capacity() + _openCheckpoints.capacity()) * sizeof(int) +
+		   qint64(_openHashes.capacity() + _openKeyHashes.capacity()) * sizeof(quint64) + keyTableBytes;
+}
+
+bool JsonStructureIndex::isAtTopLevel() const
+{
+	return _openContainers.isEmpty() && !_insideString;
+}
+
+int JsonStructureIndex::containerCount() const
+{
+	return _containers.count();
+}
+
+const JsonStructureIndex::Container &JsonStructureIndex::container(int index) const
+{
+	return _containers.at(index);
+}
+
+int JsonStructureIndex::containerEnd(int index) const
+{
+	int end = _containers.at(index).end;
+	return end < 0 ? _text.length() - 1 : end;
+}
+
+int JsonStructureIndex::rootCount() const
+{
+	return _roots.count();
+}
+
+void JsonStructureIndex::scan(int from)
+{
+	const QChar *data = _text.constData();
+	const int length = _text.length();
+
+	for (int i = from; i < length; i++)
+	{
+		const ushort c = data[i].unicode();
+
+		if (_insideString)
+		{
+			if (_escaped)
+			{
+				_escaped = false;
+			}
+			else if (c == '\\')
+			{
+				_escaped = true;
+			}
+			else if (c == '"')
+			{
+				_insideString = false;
+				_lastStringEnd = i;
+				endString();
+				continue;
+			}
+			_tokenHash = (_tokenHash ^ c) * HASH_PRIME;
+			continue;
+		}
+
+		switch (c)
+		{
+			case ' ':
+			case '\t':
+			case '\n':
+			case '\r':
+				endLiteral();
+				break;
+			case HIDDEN_CHAR:
+				endLiteral();
+				_markers.append(i);
+
+				// A marker directly after the opening brace means the container is folded.
+				if (!_openContainers.isEmpty() && _containers.at(_openContainers.last()).childCount == 0)
+				{
+					_containers[_openContainers.last()].folded = true;
+				}
+				break;
+			case '"':
+				endLiteral();
+				beginMember(i);
+				if (_openContainers.isEmpty())
+				{
+					_roots.append(i);
+				}
+				_insideString = true;
+				_lastStringStart = i;
+				_tokenHash = HASH_OFFSET ^ STRING_SEED;
+				break;
+			case ':':
+				endLiteral();
+				if (_lastStringEnd > _lastStringStart)
+				{
+					_pendingKeyStart = _lastStringStart;
+					_pendingKeyLength = _lastStringEnd - _lastStringStart + 1;
+				}
+				_expectingKey = false;
+				break;
+			case ',':
+				endLiteral();
+				if (!_openContainers.isEmpty())
+				{
+					Container &parent = _containers[_openContainers.last()];
+					if (parent.childCount++ % CheckpointStride == 0)
+					{
+						pushCheckpoint(i + 1);
+					}
+					_expectingKey = !parent.isArray;
+				}
+				_pendingKeyStart = -1;
+				break;
+			case '{':
+			case '[':
+			{
+				endLiteral();
+				beginMember(i);
+
+				Container container;
+				container.start = i;
+				container.end = -1;
+				container.parent = _openContainers.isEmpty() ? -1 : _openContainers.last();
+				container.depth = _openContainers.count();
+				container.keyStart = -1;
+				container.keyLength = 0;
+				container.childCount = 0;
+				container.firstCheckpoint = _openCheckpoints.count();
+				container.hash = 0;
+				container.isArray = (c == '[');
+				container.folded = false;
+
+				if (container.parent == -1)
+				{
+					container.indexInParent = _roots.count();
+					_roots.append(i);
+				}
+				else
+				{
+					const Container &parent = _containers.at(container.parent);
+					container.indexInParent = parent.childCount - 1;
+					if (!parent.isArray && _pendingKeyStart != -1)
+					{
+						container.keyStart = _pendingKeyStart;
+						container.keyLength = _pendingKeyLength;
+					}
+				}
+
+				_pendingKeyStart = -1;
+				_openContainers.append(_containers.count());
+				_containers.append(container);
+
+				// The key naming this container is combined with its hash once it closes.
+				_openHashes.append(container.isArray ? ARRAY_SEED : OBJECT_SEED);
+				_openKeyHashes.append(_pendingKeyHash);
+				_pendingKeyHash = 0;
+				_expectingKey = !container.isArray;
+				break;
+			}
+			case '}':
+			case ']':
+				endLiteral();
+				if (!_openContainers.isEmpty())
+				{
+					// Move this container's checkpoints out of the open stack so they stay contiguous.
+					Container &container = _containers[_openContainers.takeLast()];
+					int base = container.firstCheckpoint;
+					container.end = i;
+					container.firstCheckpoint = _checkpoints.count();
+					for (int j = base; j < _openCheckpoints.count(); j++)
+					{
+						_checkpoints.append(_openCheckpoints.at(j));
+					}
+					_openCheckpoints.resize(base);
+
+					container.hash = mixHash(_openHashes.takeLast() ^ quint64(container.childCount));
+					_pendingKeyHash = _openKeyHashes.takeLast();
+					addValueHash(container.hash);
+				}
+				_pendingKeyStart = -1;
+				_expectingKey = false;
+				break;
+			default:
+				beginMember(i);
+				if (!_insideLiteral)
+				{
+					if (_openContainers.isEmpty())
+					{
+						_roots.append(i);
+					}
+					_insideLiteral = true;
+					_tokenHash = HASH_OFFSET ^ LITERAL_SEED;
+				}
+				_tokenHash = (_tokenHash ^ c) * HASH_PRIME;
+				break;
+		}
+	}
+}
+
+void JsonStructureIndex::endString()
+{
+	if (_expectingKey)
+	{
+		_pendingKeyHash = mixHash(_tokenHash);
+	}
+	else
+	{
+		addValueHash(mixHash(_tokenHash));
+	}
+}
+
+void JsonStructureIndex::endLiteral()
+{
+	if (_insideLiteral)
+	{
+		_insideLiteral = false;
+		addValueHash(mixHash(_tokenHash));
+	}
+}
+
+void JsonStructureIndex::addValueHash(quint64 hash)
+{
+	if (_openHashes.isEmpty())
+	{
+		return;
+	}
+
+	// Arrays hash their elements in order; objects sum their members so key order doesn't matter.
+	if (_containers.at(_openContainers.last()).isArray)
+	{
+		_openHashes.last() = _openHashes.last() * HASH_PRIME + hash;
+	}
+	else
+	{
+		_openHashes.last() += mixHash(_pendingKeyHash * HASH_PRIME + hash);
+	}
+	_pendingKeyHash = 0;
+}
+
+quint64 JsonStructureIndex::mixHash(quint64 hash)
+{
+	hash ^= hash >> 30;
+	hash *= Q_UINT64_C(0xbf58476d1ce4e5b9);
+	hash ^= hash >> 27;
+	hash *= Q_UINT64_C(0x94d049bb133111eb);
+	hash ^= hash >> 31;
+	return hash;
+}
+
+void JsonStructureIndex::beginMember(int offset)
+{
+	if (!_openContainers.isEmpty())
+	{
+		Container &parent = _containers[_openContainers.last()];
+		if (parent.childCount == 0)
+		{
+			parent.childCount = 1;
+			pushCheckpoint(offset);
+		}
+	}
+}
+
+void JsonStructureIndex::pushCheckpoint(int offset)
+{
+	_openCheckpoints.append(offset);
+}
+
+int JsonStructureIndex::checkpoint(int container, int index) const
+{
+	const Container &c = _containers.at(container);
+	if (c.end < 0)
+	{
+		return _openCheckpoints.at(c.firstCheckpoint + index);
+	}
+	return _checkpoints.at(c.firstCheckpoint + index);
+}
+
+int JsonStructureIndex::containerStartingAt(int offset) const
+{
+	QVector<Container>::const_iterator it = std::lower_bound(_containers.constBegin(), _containers.constEnd(), offset,
+															  [](const Container &c, int value) { return c.start < value; });
+	if (it != _containers.constEnd() && it->start == offset)
+	{
+		return int(it - _containers.constBegin());
+	}
+	return -1;
+}
+
+int JsonStructureIndex::containerAt(int offset) const
+{
+	QVector<Container>::const_iterator it = std::upper_bound(_containers.constBegin(), _containers.constEnd(), offset,
+															  [](int value, const Container &c) { return value < c.start; });
+	int index = int(it - _containers.constBegin()) - 1;
+
+	// The closest preceding container may already be closed; walk outwards until one encloses the offset.
+	while (index != -1 && containerEnd(index) < offset)
+	{
+		index = _containers.at(index).parent;
+	}
+	return index;
+}
+
+int JsonStructureIndex::markersBefore(int offset) const
+{
+	return int(std::lower_bound(_markers.constBegin(), _markers.constEnd(), offset) - _markers.constBegin());
+}
+
+int JsonStructureIndex::offsetIncludingMarkers(int offset) const
+{
+	// The marker at _markers[i] has _markers[i] - i other characters before it, which never decreases.
+	int low = 0;
+	int high = _markers.count();
+	while (low < high)
+	{
+		int middle = (low + high) / 2;
+		if (_markers.at(middle) - middle <= offset)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return offset + low;
+}
+
+int JsonStructureIndex::memberCount(int container) const
+{
+	if (container == -1)
+	{
+		return _roots.count();
+	}
+	return _containers.at(container).childCount;
+}
+
+JsonStructureIndex::Member JsonStructureIndex::member(int container, int index) const
+{
+	Member result = { -1, -1, 0, -1, -1, -1 };
+
+	if (container == -1)
+	{
+		if (index >= 0 && index < _roots.count())
+		{
+			result.index = index;
+			result.valueStart = _roots.at(index);
+			result.container = containerStartingAt(result.valueStart);
+			result.valueEnd = result.container != -1 ? containerEnd(result.container) : scalarEnd(result.valueStart, _text.length());
+		}
+		return result;
+	}
+
+	if (index < 0 || index >= _containers.at(container).childCount)
+	{
+		return result;
+	}
+
+	// Start from the nearest checkpoint and read forward.
+	int current = index - (index % CheckpointStride);
+	int offset = checkpoint(container, current / CheckpointStride);
+	int next;
+	while (readMember(container, offset, result, next))
+	{
+		if (current == index)
+		{
+			result.index = index;
+			return result;
+		}
+		current++;
+		offset = next;
+	}
+
+	result.index = -1;
+	return result;
+}
+
+JsonStructureIndex::Member JsonStructureIndex::memberAt(int container, int offset) const
+{
+	Member result = { -1, -1, 0, -1, -1, -1 };
+
+	if (container == -1)
+	{
+		int index = int(std::upper_bound(_roots.constBegin(), _roots.constEnd(), offset) - _roots.constBegin()) - 1;
+		if (index != -1)
+		{
+			Member root = member(-1, index);
+			if (root.valueEnd >= offset)
+			{
+				return root;
+			}
+		}
+		return result;
+	}
+
+	const Container &c = _containers.at(container);
+	if (c.childCount == 0)
+	{
+		return result;
+	}
+
+	// Binary search the checkpoints for the last one at or before the offset.
+	int low = 0;
+	int high = (c.childCount - 1) / CheckpointStride;
+	while (low < high)
+	{
+		int middle = (low + high + 1) / 2;
+		if (checkpoint(container, middle) <= offset)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle - 1;
+		}
+	}
+
+	int current = low * CheckpointStride;
+	int position = checkpoint(container, low);
+	int next;
+	Member candidate;
+	while (readMember(container, position, candidate, next))
+	{
+		candidate.index = current;
+		result = candidate;
+		if (next > offset)
+		{
+			break;
+		}
+		current++;
+		position = next;
+	}
+	return result;
+}
+
+QVector<JsonStructureIndex::Member> JsonStructureIndex::members(int container) const
+{
+	QVector<Member> result;
+	if (container == -1)
+	{
+		for (int i = 0; i < _roots.count(); i++)
+		{
+			result.append(member(-1, i));
+		}
+		return result;
+	}
+
+	const Container &c = _containers.at(container);
+	if (c.childCount == 0)
+	{
+		return result;
+	}
+
+	result.reserve(c.childCount);
+
+	Member member;
+	int offset = checkpoint(container, 0);
+	int next;
+	while (readMember(container, offset, member, next))
+	{
+		member.index = result.count();
+		result.append(member);
+		offset = next;
+	}
+	return result;
+}
+
+QVector<JsonStructureIndex::Member> JsonStructureIndex::members(int container, int from, int count) const
+{
+	QVector<Member> result;
+	int last = qMin(from + count, memberCount(container));
+	if (from < 0 || from >= last)
+	{
+		return result;
+	}
+
+	result.reserve(last - from);
+	if (container == -1)
+	{
+		for (int i = from; i < last; i++)
+		{
+			result.append(member(-1, i));
+		}
+		return result;
+	}
+
+	// Start from the nearest checkpoint and read forward.
+	int current = from - (from % CheckpointStride);
+	int offset = checkpoint(container, current / CheckpointStride);
+	int next;
+	Member member;
+	while (current < last && readMember(container, offset, member, next))
+	{
+		if (current >= from)
+		{
+			member.index = current;
+			result.append(member);
+		}
+		current++;
+		offset = next;
+	}
+	return result;
+}
+
+JsonStructureIndex::Member JsonStructureIndex::findMember(int container, const QString &key) const
+{
+	Member result = { -1, -1, 0, -1, -1, -1 };
+	if (container == -1 || _containers.at(container).isArray || _containers.at(container).childCount == 0)
+	{
+		return result;
+	}
+
+	QStringRef needle = key.midRef(0);
+	int next;
+	if (_containers.at(container).childCount < KeyTableMinMembers)
+	{
+		// Small objects are quicker to read through than to build a table for.
+		int index = 0;
+		int offset = checkpoint(container, 0);
+		while (readMember(container, offset, result, next))
+		{
+			KeyEntry entry = { result.keyStart, result.keyLength, index, false };
+			entry.escaped = result.keyLength >= 2 && _text.midRef(result.keyStart + 1, result.keyLength - 2).contains('\\');
+			if (result.keyLength >= 2 && compareKey(entry, needle) == 0)
+			{
+				result.index = index;
+				return result;
+			}
+			index++;
+			offset = next;
+		}
+
+		result.index = -1;
+		return result;
+	}
+
+	// The first of equal keys is the one earliest in the object, as the table is sorted stably.
+	QVector<KeyEntry> table = keyTable(container);
+	QVector<KeyEntry>::const_iterator it = std::lower_bound(table.constBegin(), table.constEnd(), needle,
+															[this](const KeyEntry &entry, const QStringRef &value) { return compareKey(entry, value) < 0; });
+	if (it == table.constEnd() || compareKey(*it, needle) != 0 || !readMember(container, it->keyStart, result, next))
+	{
+		result.index = -1;
+		return result;
+	}
+	result.index = it->index;
+	return result;
+}
+
+QVector<JsonStructureIndex::KeyEntry> JsonStructureIndex::keyTable(int container) const
+{
+	// The table is copied out under the lock, as another thread may add one of its own meanwhile.
+	_keyTables->mutex.lock();
+	QVector<KeyEntry> table = _keyTables->tables.value(container);
+	_keyTables->mutex.unlock();
+	if (!table.isEmpty())
+	{
+		return table;
+	}
+
+	QVector<Member> keys = members(container);
+	table.reserve(keys.count());
+	for (int i = 0; i < keys.count(); i++)
+	{
+		const Member &member = keys.at(i);
+		if (member.keyLength >= 2)
+		{
+			KeyEntry entry = { member.keyStart, member.keyLength, member.index,
+							   _text.midRef(member.keyStart + 1, member.keyLength - 2).contains('\\') };
+			table.append(entry);
+		}
+	}
+	std::stable_sort(table.begin(), table.end(), [this](const KeyEntry &left, const KeyEntry &right)
+	{
+		if (right.escaped)
+		{
+			QString key = unescapedString(_text.midRef(right.keyStart + 1, right.keyLength - 2));
+			return compareKey(left, key.midRef(0)) < 0;
+		}
+		return compareKey(left, _text.midRef(right.keyStart + 1, right.keyLength - 2)) < 0;
+	});
+
+	// Two threads can build the same table; either copy will do.
+	_keyTables->mutex.lock();
+	_keyTables->tables.insert(container, table);
+	_keyTables->mutex.unlock();
+	return table;
+}
+
+int JsonStructureIndex::compareKey(const KeyEntry &entry, const QStringRef &key) const
+{
+	QStringRef raw = _text.midRef(entry.keyStart + 1, entry.keyLength - 2);
+	if (entry.escaped)
+	{
+		QString unescaped = unescapedString(raw);
+		return unescaped.midRef(0).compare(key);
+	}
+	return raw.compare(key);
+}
+
+void JsonStructureIndex::resetKeyTables()
+{
+	// Copies of the index sharing the old tables keep them, as their text hasn't changed.
+	_keyTables = QSharedPointer<KeyTables>(new KeyTables);
+}
+
+QString JsonStructureIndex::unescapedString(const QStringRef &raw)
+{
+	if (!raw.contains('\\'))
+	{
+		return raw.toString();
+	}
+
+	QString key;
+	key.reserve(raw.length());
+	for (int i = 0; i < raw.length(); i++)
+	{
+		QChar c = raw.at(i);
+		if (c != '\\' || i + 1 >= raw.length())
+		{
+			key += c;
+			continue;
+		}
+
+		c = raw.at(++i);
+		switch (c.unicode())
+		{
+			case 'b':
+				key += '\b';
+				break;
+			case 'f':
+				key += '\f';
+				break;
+			case 'n':
+				key += '\n';
+				break;
+			case 'r':
+				key += '\r';
+				break;
+			case 't':
+				key += '\t';
+				break;
+			case 'u':
+			{
+				// Surrogate pairs come as two escapes in a row, each giving one half.
+				ushort code = 0;
+				int digits = 0;
+				while (digits < 4 && i + 1 + digits < raw.length())
+				{
+					int digit = hexDigit(raw.at(i + 1 + digits).unicode());
+					if (digit == -1)
+					{
+						break;
+					}
+					code = ushort(code * 16 + digit);
+					digits++;
+				}
+				if (digits == 4)
+				{
+					key += QChar(code);
+					i += 4;
+				}
+				else
+				{
+					key += c;
+				}
+				break;
+			}
+			default:
+				// Quotes, backslashes and slashes stand for themselves.
+				key += c;
+				break;
+		}
+	}
+	return key;
+}
+
+QString JsonStructureIndex::keyName(const Member &member) const
+{
+	if (member.keyStart < 0 || member.keyLength < 2)
+	{
+		return QString();
+	}
+	return unescapedString(_text.midRef(member.keyStart + 1, member.keyLength - 2));
+}
+
+int JsonStructureIndex::skipWhitespace(int offset, int limit) const
+{
+	const QChar *data = _text.constData();
+	while (offset < limit)
+	{
+		ushort c = data[offset].unicode();
+		if (c != ' ' && c != '\t' && c != '\n' && c != '\r' && c != HIDDEN_CHAR)
+		{
+			break;
+		}
+		offset++;
+	}
+	return offset;
+}
+
+int JsonStructureIndex::stringEnd(int offset, int limit) const
+{
+	const QChar *data = _text.constData();
+	for (int i = offset + 1; i < limit; i++)
+	{
+		if (data[i] == '\\')
+		{
+			i++;
+		}
+		else if (data[i] == '"')
+		{
+			return i;
+		}
+	}
+	return limit - 1;
+}
+
+int JsonStructureIndex::scalarEnd(int offset, int limit) const
+{
+	const QChar *data = _text.constData();
+	if (data[offset] == '"')
+	{
+		return stringEnd(offset, limit);
+	}
+
+	int end = offset;
+	while (end < limit)
+	{
+		ushort c = data[end].unicode();
+		if (c == ',' || c == '}' || c == ']' || c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == HIDDEN_CHAR)
+		{
+			break;
+		}
+		end++;
+	}
+	return end - 1;
+}
+
+bool JsonStructureIndex::readMember(int container, int offset, Member &member, int &next) const
+{
+	const Container &c = _containers.at(container);
+	const QChar *data = _text.constData();
+	const int limit = c.end < 0 ? _text.length() : c.end;
+
+	int position = skipWhitespace(offset, limit);
+	if (position >= limit)
+	{
+		return false;
+	}
+
+	member.keyStart = -1;
+	member.keyLength = 0;
+	member.container = -1;
+
+	if (!c.isArray && data[position] == '"')
+	{
+		member.keyStart = position;
+		position = stringEnd(position, limit);
+		member.keyLength = position - member.keyStart + 1;
+		position = skipWhitespace(position + 1, limit);
+		if (position < limit && data[position] == ':')
+		{
+			position = skipWhitespace(position + 1, limit);
+		}
+	}
+
+	member.valueStart = position;
+	if (position >= limit || data[position] == ',')
+	{
+		member.valueEnd = position - 1;
+	}
+	else if (data[position] == '{' || data[position] == '[')
+	{
+		member.container = containerStartingAt(position);
+		member.valueEnd = member.container != -1 ? containerEnd(member.container) : position;
+	}
+	else
+	{
+		member.valueEnd = scalarEnd(position, limit);
+	}
+
+	next = skipWhitespace(member.valueEnd + 1, limit);
+	if (next < limit && data[next] == ',')
+	{
+		next++;
+	}
+
+	// Always make progress, even through malformed input.
+	if (next <= offset)
+	{
+		next = offset + 1;
+	}
+	return true;
+}
+
+QString JsonStructureIndex::pathAt(int offset) const
+{
+	int container = containerAt(offset);
+	if (container == -1)
+	{
+		// A top-level scalar has no members of its own.
+		Member root = memberAt(-1, offset);
+		if (root.index == -1)
+		{
+			return QString();
+		}
+		return _roots.count() > 1 ? QString("$[%1]").arg(root.index) : QString("$");
+	}
+
+	QStringList components;
+
+	// The member under the offset, unless the offset is on the container's own brace.
+	Member member = memberAt(container, offset);
+	if (member.index != -1 && offset >= (member.keyStart != -1 ? member.keyStart : member.valueStart))
+	{
+		if (member.keyStart != -1)
+		{
+			components.prepend(pathComponent(keyName(member)));
+		}
+		else
+		{
+			components.prepend(QString("[%1]").arg(member.index));
+		}
+	}
+
+	// Then every enclosing container.
+	for (; container != -1; container = _containers.at(container).parent)
+	{
+		const Container &c = _containers.at(container);
+		if (c.parent == -1)
+		{
+			if (_roots.count() > 1)
+			{
+				components.prepend(QString("[%1]").arg(c.indexInParent));
+			}
+		}
+		else if (c.keyStart != -1)
+		{
+			components.prepend(pathComponent(unescapedString(_text.midRef(c.keyStart + 1, c.keyLength - 2))));
+		}
+		else
+		{
+			components.prepend(QString("[%1]").arg(c.indexInParent));
+		}
+	}
+
+	return "$" + components.join("");
+}
+
+int JsonStructureIndex::offsetForPath(const QString &path) const
+{
+	QVector<PathToken> tokens;
+	if (_roots.isEmpty() || !parsePath(path, tokens))
+	{
+		return -1;
+	}
+
+	// With several top-level values the first token picks one of them.
+	int first = 0;
+	Member member = this->member(-1, 0);
+	if (_roots.count() > 1)
+	{
+		if (tokens.isEmpty() || tokens.first().index < 0 || tokens.first().index >= _roots.count())
+		{
+			return -1;
+		}
+		member = this->member(-1, tokens.first().index);
+		first = 1;
+	}
+
+	int container = member.container;
+	for (int i = first; i < tokens.count(); i++)
+	{
+		if (container == -1)
+		{
+			// Scalars have no children.
+			return -1;
+		}
+
+		const PathToken &token = tokens.at(i);
+		if (_containers.at(container).isArray)
+		{
+			member = this->member(container, token.index);
+		}
+		else
+		{
+			member = findMember(container, token.key);
+		}
+
+		if (member.index == -1)
+		{
+			return -1;
+		}
+		container = member.container;
+	}
+
+	return member.keyStart != -1 ? member.keyStart : member.valueStart;
+}
+
+QString JsonStructureIndex::pathComponent(const QString &key)
+{
+	static const QRegularExpression identifier("^[A-Za-z_$][A-Za-z0-9_$]*$");
+	if (identifier.match(key).hasMatch())
+	{
+		return "." + key;
+	}
+
+	QString escaped = key;
+	escaped.replace("\\", "\\\\").replace("'", "\\'");
+	return "['" + escaped + "']";
+}
+
+bool JsonStructureIndex::parsePath(const QString &path, QVector<PathToken> &tokens)
+{
+	QString trimmed = path.trimmed();
+
+	// JSON Pointer, e.g. /data/1423/attributes
+	if (trimmed.isEmpty() || trimmed.startsWith('/'))
+	{
+		QStringList parts = trimmed.split('/');
+		for (int i = 1; i < parts.count(); i++)
+		{
+			PathToken token;
+			token.key = parts.at(i);
+			token.key.replace("~1", "/").replace("~0", "~");
+
+			bool isNumber;
+			token.index = token.key.toInt(&isNumber);
+			if (!isNumber)
+			{
+				token.index = -1;
+			}
+			tokens.append(token);
+		}
+		return true;
+	}
+
+	// JSONPath, e.g. $.data[1423]['attributes']
+	int i = trimmed.startsWith('$') ? 1 : 0;
+	while (i < trimmed.length())
+	{
+		PathToken token;
+		token.index = -1;
+
+		if (trimmed.at(i) == '[')
+		{
+			i++;
+			if (i < trimmed.length() && (trimmed.at(i) == '\'' || trimmed.at(i) == '"'))
+			{
+				QChar quote = trimmed.at(i++);
+				while (i < trimmed.length() && trimmed.at(i) != quote)
+				{
+					if (trimmed.at(i) == '\\' && i + 1 < trimmed.length())
+					{
+						i++;
+					}
+					token.key += trimmed.at(i++);
+				}
+				i++;
+			}
+			else
+			{
+				int close = trimmed.indexOf(']', i);
+				if (close == -1)
+				{
+					return false;
+				}
+
+				bool isNumber;
+				token.key = trimmed.mid(i, close - i).trimmed();
+				token.index = token.key.toInt(&isNumber);
+				if (!isNumber)
+				{
+					return false;
+				}
+				i = close;
+			}
+
+			if (i >= trimmed.length() || trimmed.at(i) != ']')
+			{
+				return false;
+			}
+			i++;
+		}
+		else
+		{
+			if (trimmed.at(i) == '.')
+			{
+				i++;
+			}
+
+			int start = i;
+			while (i < trimmed.length() && trimmed.at(i) != '.' && trimmed.at(i) != '[')
+			{
+				i++;
+			}
+			token.key = trimmed.mid(start, i - start);
+
+			bool isNumber;
+			token.index = token.key.toInt(&isNumber);
+			if (!isNumber)
+			{
+				token.index = -1;
+			}
+		}
+
+		tokens.append(token);
+	}
+	return true;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file jsonstructureindex.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Compact index of the objects and arrays within a JSON document.
+ */
+#ifndef JSONSTRUCTUREINDEX_H
+#define JSONSTRUCTUREINDEX_H
+
+#include <QString>
+#include <QVector>
+#include <QBitArray>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+
+class QDataStream;
+
+#define HIDDEN_CHAR		'\31'
+#define ELLIPSES		"\u2060\u2026\u2060"
+#define ELLIPSES_CHAR	0x2060			///< First character of ELLIPSES.
+
+/**
+ * Records the offset, extent and key of every container in a JSON text in a single pass.
+ * Containers are stored in document order, so lookups by offset are binary searches.
+ * Scalar members are not stored; they are read back from the text on demand, starting
+ * from a checkpoint recorded every CheckpointStride members.  Top-level values, scalars
+ * included, are recorded by their offset, so multi-value files keep their numbering.
+ *
+ * Each container also gets a Merkle-style hash of its contents, so identical subtrees of
+ * two documents can be recognised without reading them.
+ *
+ * Keys are looked up by their unescaped text.  Objects with KeyTableMinMembers members or
+ * more get a table of their keys in sorted order the first time one is looked up, which is
+ * kept until the text changes, so each later lookup is a binary search.
+ */
+class JsonStructureIndex
+{
+public:
+	struct Container
+	{
+		int start;				///< Offset of the opening brace or bracket.
+		int end;				///< Offset of the closing brace or bracket, or -1 if unterminated.
+		int parent;				///< Index of the enclosing container, or -1 for a root.
+		int depth;
+		int keyStart;			///< Offset of the key naming this container in its parent object, or -1.
+		int keyLength;			///< Length of that key, including quotes.
+		int indexInParent;		///< Position among the members of the parent, or among the top-level values.
+		int childCount;
+		int firstCheckpoint;
+		quint64 hash;			///< Hash of the contents, independent of whitespace and object key order.
+		bool isArray;
+		bool folded;			///< Whether the container is collapsed with HIDDEN_CHAR markers.
+	};
+
+	struct Member
+	{
+		int index;
+		int keyStart;			///< Offset of the member key (including quotes), or -1 for array elements.
+		int keyLength;
+		int valueStart;
+		int valueEnd;			///< Offset of the last character of the value.
+		int container;			///< Index of the container holding the value, or -1 for scalars.
+	};
+
+	static const int CheckpointStride = 64;
+	static const int KeyTableMinMembers = 32;
+
+	JsonStructureIndex();
+
+	void clear();
+	void build(const QString &text);
+	void append(const QString &text);
+	int setFolds(const QBitArray &folds, int position);
+
+	void save(QDataStream &stream) const;
+	bool load(QDataStream &stream, const QString &text);
+
+	const QString &text() const;
+	bool isEmpty() const;
+	qint64 memoryUsage() const;
+	bool isAtTopLevel() const;
+
+	int containerCount() const;
+	const Container &container(int index) const;
+	int containerEnd(int index) const;
+	int rootCount() const;
+
+	int containerStartingAt(int offset) const;
+	int containerAt(int offset) const;
+	int markersBefore(int offset) const;
+	int offsetIncludingMarkers(int offset) const;
+
+	int memberCount(int container) const;
+	Member member(int container, int index) const;
+	Member memberAt(int container, int offset) const;
+	QVector<Member> members(int container) const;
+	QVector<Member> members(int container, int from, int count) const;
+	Member findMember(int container, const QString &key) const;
+	QString keyName(const Member &member) const;
+
+	QString pathAt(int offset) const;
+	int offsetForPath(const QString &path) const;
+
+	static QString pathComponent(const QString &key);
+	static QString unescapedString(const QStringRef &raw);
+
+private:
+	struct PathToken
+	{
+		QString key;
+		int index;				///< Array index, or -1 when the token can only be a key.
+	};
+
+	struct KeyEntry
+	{
+		int keyStart;
+		int keyLength;
+		int index;
+		bool escaped;			///< Whether the key has to be unescaped before comparing it.
+	};
+
+	/// Shared by copies of the index until either of them changes its text.
+	struct KeyTables
+	{
+		QMutex mutex;
+		QHash<int, QVector<KeyEntry> > tables;
+	};
+
+	static bool parsePath(const QString &path, QVector<PathToken> &tokens);
+
+	void scan(int from);
+	void beginMember(int offset);
+	void pushCheckpoint(int offset);
+	void endString();
+	void endLiteral();
+	void addValueHash(quint64 hash);
+
+	static quint64 mixHash(quint64 hash);
+
+	int checkpoint(int container, int index) const;
+	int skipWhitespace(int offset, int limit) const;
+	int stringEnd(int offset, int limit) const;
+	int scalarEnd(int offset, int limit) const;
+	bool readMember(int container, int offset, Member &member, int &next) const;
+	bool isConsistentWith(const QString &text) const;
+	QVector<KeyEntry> keyTable(int container) const;
+	int compareKey(const KeyEntry &entry, const QStringRef &key) const;
+	void resetKeyTables();
+
+	QString _text;
+	QVector<Container> _containers;
+	QVector<int> _checkpoints;
+	QVector<int> _roots;				///< Offset of every top-level value.
+	QVector<int> _markers;
+	QSharedPointer<KeyTables> _keyTables;
+
+	// Scanner state.
+	QVector<int> _openContainers;
+	QVector<int> _openCheckpoints;
+	bool _insideString;
+	bool _escaped;
+	int _lastStringStart;
+	int _lastStringEnd;
+	int _pendingKeyStart;
+	int _pendingKeyLength;
+
+	QVector<quint64> _openHashes;
+	QVector<quint64> _openKeyHashes;
+	quint64 _tokenHash;
+	quint64 _pendingKeyHash;
+	bool _insideLiteral;
+	bool _expectingKey;
+};
+
+#endif // JSONSTRUCTUREINDEX_H
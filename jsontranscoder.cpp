@@ -0,0 +1,1266 @@
+/**
+ * @file jsontranscoder.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsontranscoder.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QDateTime>
+#include <cstring>
+#include <cmath>
+
+#ifdef JSONPAD_TRANSCODER_BENCHMARK
+#include <QCborValue>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#endif
+
+#define TEXT_CHUNK_SIZE			(1024 * 1024)
+#define OUTPUT_BUFFER_SIZE		(1024 * 1024)
+
+static inline bool isDelimiter(ushort c)
+{
+	return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == ',' || c == ':' || c == ']' || c == '}' || c == HIDDEN_CHAR;
+}
+
+JsonTranscoder::JsonTranscoder(Direction direction, const QString &fileName, Format format, QObject *parent) :
+	QThread(parent),
+	_direction(direction),
+	_fileName(fileName),
+	_format(format),
+	_data(NULL),
+	_size(0),
+	_position(0),
+	_outputFailed(false),
+	_progress(0),
+	_cancelled(0),
+	_succeeded(false)
+{
+}
+
+JsonTranscoder::~JsonTranscoder()
+{
+	cancel();
+	wait();
+}
+
+JsonTranscoder::Format JsonTranscoder::formatForFile(const QString &fileName)
+{
+	QString suffix = QFileInfo(fileName).suffix().toLower();
+	if (suffix == "cbor")
+	{
+		return Cbor;
+	}
+	if (suffix == "msgpack" || suffix == "mpk")
+	{
+		return MessagePack;
+	}
+	return Json;
+}
+
+QString JsonTranscoder::formatName(Format format)
+{
+	switch (format)
+	{
+		case Cbor:
+			return "CBOR";
+		case MessagePack:
+			return "MessagePack";
+		default:
+			return "JSON";
+	}
+}
+
+void JsonTranscoder::setText(const QString &text)
+{
+	_text = text;
+}
+
+const JsonStructureIndex &JsonTranscoder::index() const
+{
+	return _index;
+}
+
+bool JsonTranscoder::succeeded() const
+{
+	return _succeeded;
+}
+
+bool JsonTranscoder::wasCancelled() const
+{
+	return _cancelled.load() != 0;
+}
+
+QString JsonTranscoder::errorString() const
+{
+	return _error;
+}
+
+void JsonTranscoder::cancel()
+{
+	_cancelled.store(1);
+}
+
+void JsonTranscoder::run()
+{
+	qint64 timeStart = QDateTime::currentMSecsSinceEpoch();
+
+	_succeeded = _direction == Import ? importFile() : exportText();
+	if (!_succeeded)
+	{
+		return;
+	}
+
+	emit progressChanged(100);
+	qDebug("time to transcode %s: %lld ms", qPrintable(formatName(_format)), QDateTime::currentMSecsSinceEpoch() - timeStart);
+
+#ifdef JSONPAD_TRANSCODER_BENCHMARK
+	benchmarkRoundTrip();
+#endif
+}
+
+bool JsonTranscoder::importFile()
+{
+	QFile file(_fileName);
+	if (!file.open(QFile::ReadOnly))
+	{
+		_error = QString("Could not open %1: %2").arg(_fileName, file.errorString());
+		return false;
+	}
+
+	_size = file.size();
+	uchar *mapped = _size > 0 ? file.map(0, _size) : NULL;
+	if (_size > 0 && mapped == NULL)
+	{
+		_error = QString("Could not map %1: %2").arg(_fileName, file.errorString());
+		return false;
+	}
+	_data = reinterpret_cast<const char *>(mapped);
+	_position = 0;
+	_index.clear();
+	_textBuffer.reserve(TEXT_CHUNK_SIZE + 64);
+
+	// Nesting is tracked on an explicit stack, since documents can be nested far deeper than the call stack allows.
+	QVector<ImportFrame> stack;
+	bool firstValue = true;
+	bool succeeded = true;
+
+	while (succeeded)
+	{
+		if (_cancelled.load())
+		{
+			succeeded = fail(_position, "Cancelled");
+			break;
+		}
+
+		if (!stack.isEmpty())
+		{
+			const ImportFrame &frame = stack.last();
+			if (frame.remaining == 0 && frame.atKey)
+			{
+				appendText(QChar(frame.map ? '}' : ']'));
+				stack.removeLast();
+				continue;
+			}
+		}
+		else if (_position >= _size)
+		{
+			break;
+		}
+		else
+		{
+			// A sequence of top-level items is shown one per line.
+			if (!firstValue)
+			{
+				appendText(QChar('\n'));
+			}
+			firstValue = false;
+		}
+
+		qint64 itemStart = _position;
+		Item item;
+		if (!readItem(item))
+		{
+			succeeded = false;
+			break;
+		}
+
+		if (item.type == Item::Break)
+		{
+			if (stack.isEmpty() || stack.last().remaining != -1 || !stack.last().atKey)
+			{
+				succeeded = fail(itemStart, "Unexpected break");
+				break;
+			}
+			appendText(QChar(stack.last().map ? '}' : ']'));
+			stack.removeLast();
+			continue;
+		}
+
+		if (!stack.isEmpty())
+		{
+			ImportFrame &frame = stack.last();
+			if (!frame.map || frame.atKey)
+			{
+				if (!frame.first)
+				{
+					appendText(QChar(','));
+				}
+				frame.first = false;
+				if (frame.remaining > 0)
+				{
+					frame.remaining--;
+				}
+			}
+
+			if (frame.map && frame.atKey)
+			{
+				frame.atKey = false;
+				if (!writeKey(item))
+				{
+					succeeded = fail(itemStart, "Map keys must be scalar values");
+					break;
+				}
+				appendText(QChar(':'));
+				continue;
+			}
+			frame.atKey = true;
+		}
+
+		if (item.type == Item::Array || item.type == Item::Map)
+		{
+			ImportFrame frame;
+			frame.map = item.type == Item::Map;
+			frame.first = true;
+			frame.atKey = true;
+			frame.remaining = item.count;
+			stack.append(frame);
+			appendText(QChar(frame.map ? '{' : '['));
+		}
+		else
+		{
+			writeScalar(item);
+		}
+	}
+
+	if (succeeded && !stack.isEmpty())
+	{
+		succeeded = fail(_position, "Unexpected end of data");
+	}
+
+	flushText();
+	file.unmap(mapped);
+	_data = NULL;
+	_chunks.clear();
+	return succeeded;
+}
+
+bool JsonTranscoder::readItem(Item &item)
+{
+	item.count = 0;
+	item.data = NULL;
+	item.length = 0;
+	return _format == Cbor ? readCborItem(item) : readMessagePackItem(item);
+}
+
+bool JsonTranscoder::readCborItem(Item &item)
+{
+	// Tags only add meaning to the item after them, so they are skipped.
+	while (true)
+	{
+		if (_position >= _size)
+		{
+			return fail(_position, "Unexpected end of data");
+		}
+
+		quint8 initial = quint8(_data[_position++]);
+		int major = initial >> 5;
+		int info = initial & 0x1f;
+
+		if (major == 7)
+		{
+			switch (info)
+			{
+				case 20:
+					item.type = Item::False;
+					return true;
+				case 21:
+					item.type = Item::True;
+					return true;
+				case 25:
+				{
+					quint64 half;
+					if (!readBigEndian(2, half))
+					{
+						return false;
+					}
+					int exponent = (half >> 10) & 0x1f;
+					int mantissa = half & 0x3ff;
+					double value = exponent == 0 ? std::ldexp(double(mantissa), -24) :
+								   exponent == 31 ? (mantissa == 0 ? INFINITY : NAN) :
+								   std::ldexp(double(mantissa + 1024), exponent - 25);
+					item.type = Item::Float;
+					item.real = (half & 0x8000) ? -value : value;
+					return true;
+				}
+				case 26:
+				{
+					quint64 bits;
+					if (!readBigEndian(4, bits))
+					{
+						return false;
+					}
+					quint32 bits32 = quint32(bits);
+					float value;
+					std::memcpy(&value, &bits32, sizeof(value));
+					item.type = Item::Float;
+					item.real = value;
+					return true;
+				}
+				case 27:
+				{
+					quint64 bits;
+					if (!readBigEndian(8, bits))
+					{
+						return false;
+					}
+					std::memcpy(&item.real, &bits, sizeof(item.real));
+					item.type = Item::Double;
+					return true;
+				}
+				case 31:
+					item.type = Item::Break;
+					return true;
+				case 24:
+					// Simple values have no JSON equivalent.
+					_position++;
+					item.type = Item::Null;
+					return _position <= _size || fail(_position, "Unexpected end of data");
+				default:
+					if (info > 24)
+					{
+						return fail(_position - 1, "Invalid simple value");
+					}
+					item.type = Item::Null;
+					return true;
+			}
+		}
+
+		quint64 argument = quint64(info);
+		bool indefinite = info == 31;
+		if (info >= 24 && info <= 27)
+		{
+			if (!readBigEndian(1 << (info - 24), argument))
+			{
+				return false;
+			}
+		}
+		else if (info > 27 && !indefinite)
+		{
+			return fail(_position - 1, "Invalid additional information");
+		}
+		if (indefinite && (major < 2 || major > 5))
+		{
+			return fail(_position - 1, "Invalid indefinite length");
+		}
+
+		switch (major)
+		{
+			case 0:
+				item.type = Item::Unsigned;
+				item.number = argument;
+				return true;
+			case 1:
+				item.type = Item::Negative;
+				item.number = argument;
+				return true;
+			case 2:
+			case 3:
+				item.type = major == 2 ? Item::Bytes : Item::String;
+				if (!indefinite)
+				{
+					return readBytes(qint64(argument), item);
+				}
+
+				// Chunked strings are joined before they are written.
+				_chunks.clear();
+				while (true)
+				{
+					if (_position >= _size)
+					{
+						return fail(_position, "Unexpected end of data");
+					}
+					quint8 chunkInitial = quint8(_data[_position++]);
+					if (chunkInitial == 0xff)
+					{
+						break;
+					}
+					quint64 chunkLength = chunkInitial & 0x1f;
+					if ((chunkInitial >> 5) != major || chunkLength > 27 ||
+						(chunkLength >= 24 && !readBigEndian(1 << (chunkLength - 24), chunkLength)))
+					{
+						return _error.isEmpty() ? fail(_position - 1, "Invalid string chunk") : false;
+					}
+					Item chunk;
+					if (!readBytes(qint64(chunkLength), chunk))
+					{
+						return false;
+					}
+					_chunks.append(chunk.data, int(chunk.length));
+				}
+				item.data = _chunks.constData();
+				item.length = _chunks.size();
+				return true;
+			case 4:
+			case 5:
+				item.type = major == 4 ? Item::Array : Item::Map;
+				item.count = indefinite ? -1 : qint64(qMin(argument, quint64(Q_INT64_C(0x7fffffffffffffff))));
+				return true;
+			default:
+				break;
+		}
+	}
+}
+
+bool JsonTranscoder::readMessagePackItem(Item &item)
+{
+	if (_position >= _size)
+	{
+		return fail(_position, "Unexpected end of data");
+	}
+
+	quint8 initial = quint8(_data[_position++]);
+	quint64 value;
+
+	if (initial <= 0x7f)
+	{
+		item.type = Item::Unsigned;
+		item.number = initial;
+		return true;
+	}
+	if (initial >= 0xe0)
+	{
+		item.type = Item::Negative;
+		item.number = quint64(-1 - qint64(qint8(initial)));
+		return true;
+	}
+	if (initial <= 0x8f || (initial >= 0x90 && initial <= 0x9f))
+	{
+		item.type = initial <= 0x8f ? Item::Map : Item::Array;
+		item.count = initial & 0x0f;
+		return true;
+	}
+	if (initial >= 0xa0 && initial <= 0xbf)
+	{
+		item.type = Item::String;
+		return readBytes(initial & 0x1f, item);
+	}
+
+	switch (initial)
+	{
+		case 0xc0:
+			item.type = Item::Null;
+			return true;
+		case 0xc2:
+			item.type = Item::False;
+			return true;
+		case 0xc3:
+			item.type = Item::True;
+			return true;
+		case 0xc4:
+		case 0xc5:
+		case 0xc6:
+			item.type = Item::Bytes;
+			return readBigEndian(1 << (initial - 0xc4), value) && readBytes(qint64(value), item);
+		case 0xc7:
+		case 0xc8:
+		case 0xc9:
+			// Extension types are shown as their data, without the type.
+			item.type = Item::Bytes;
+			return readBigEndian(1 << (initial - 0xc7), value) && readBigEndian(1, item.number) && readBytes(qint64(value), item);
+		case 0xca:
+		{
+			if (!readBigEndian(4, value))
+			{
+				return false;
+			}
+			quint32 bits32 = quint32(value);
+			float real;
+			std::memcpy(&real, &bits32, sizeof(real));
+			item.type = Item::Float;
+			item.real = real;
+			return true;
+		}
+		case 0xcb:
+			if (!readBigEndian(8, value))
+			{
+				return false;
+			}
+			std::memcpy(&item.real, &value, sizeof(item.real));
+			item.type = Item::Double;
+			return true;
+		case 0xcc:
+		case 0xcd:
+		case 0xce:
+		case 0xcf:
+			item.type = Item::Unsigned;
+			return readBigEndian(1 << (initial - 0xcc), item.number);
+		case 0xd0:
+		case 0xd1:
+		case 0xd2:
+		case 0xd3:
+		{
+			int size = 1 << (initial - 0xd0);
+			if (!readBigEndian(size, value))
+			{
+				return false;
+			}
+			// Sign-extend from the stored width.
+			int shift = 64 - size * 8;
+			qint64 signedValue = qint64(value << shift) >> shift;
+			item.type = signedValue < 0 ? Item::Negative : Item::Unsigned;
+			item.number = signedValue < 0 ? quint64(-1 - signedValue) : quint64(signedValue);
+			return true;
+		}
+		case 0xd4:
+		case 0xd5:
+		case 0xd6:
+		case 0xd7:
+		case 0xd8:
+			item.type = Item::Bytes;
+			return readBigEndian(1, item.number) && readBytes(1 << (initial - 0xd4), item);
+		case 0xd9:
+		case 0xda:
+		case 0xdb:
+			item.type = Item::String;
+			return readBigEndian(1 << (initial - 0xd9), value) && readBytes(qint64(value), item);
+		case 0xdc:
+		case 0xdd:
+			item.type = Item::Array;
+			return readBigEndian(initial == 0xdc ? 2 : 4, value) && ((item.count = qint64(value)), true);
+		case 0xde:
+		case 0xdf:
+			item.type = Item::Map;
+			return readBigEndian(initial == 0xde ? 2 : 4, value) && ((item.count = qint64(value)), true);
+		default:
+			return fail(_position - 1, "Invalid type");
+	}
+}
+
+bool JsonTranscoder::readBytes(qint64 length, Item &item)
+{
+	if (length < 0 || length > _size - _position)
+	{
+		return fail(_position, "Unexpected end of data");
+	}
+	item.data = _data + _position;
+	item.length = length;
+	_position += length;
+	return true;
+}
+
+bool JsonTranscoder::readBigEndian(int size, quint64 &value)
+{
+	if (size > _size - _position)
+	{
+		return fail(_position, "Unexpected end of data");
+	}
+	value = 0;
+	for (int i = 0; i < size; i++)
+	{
+		value = (value << 8) | quint8(_data[_position++]);
+	}
+	return true;
+}
+
+bool JsonTranscoder::writeScalar(const Item &item)
+{
+	switch (item.type)
+	{
+		case Item::Unsigned:
+			appendText(QString::number(item.number));
+			return true;
+		case Item::Negative:
+			if (item.number < quint64(Q_INT64_C(0x7fffffffffffffff)))
+			{
+				appendText(QString::number(-1 - qint64(item.number)));
+			}
+			else if (item.number == Q_UINT64_C(0xffffffffffffffff))
+			{
+				appendText("-18446744073709551616");
+			}
+			else
+			{
+				appendText("-" + QString::number(item.number + 1));
+			}
+			return true;
+		case Item::Float:
+		case Item::Double:
+			if (!std::isfinite(item.real))
+			{
+				appendText("null");
+			}
+			else if (item.type == Item::Float)
+			{
+				// Use the shortest text that reads back as the same single precision value.
+				for (int precision = 1; precision <= 9; precision++)
+				{
+					QString number = QString::number(item.real, 'g', precision);
+					if (precision == 9 || number.toFloat() == float(item.real))
+					{
+						appendText(number);
+						break;
+					}
+				}
+			}
+			else
+			{
+				appendText(QString::number(item.real, 'g', QLocale::FloatingPointShortest));
+			}
+			return true;
+		case Item::String:
+			writeString(item.data, item.length);
+			return true;
+		case Item::Bytes:
+		{
+			QByteArray encoded = QByteArray::fromRawData(item.data, int(item.length)).toBase64(QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals);
+			appendText(QChar('"'));
+			appendText(QString::fromLatin1(encoded));
+			appendText(QChar('"'));
+			return true;
+		}
+		case Item::True:
+			appendText("true");
+			return true;
+		case Item::False:
+			appendText("false");
+			return true;
+		case Item::Null:
+			appendText("null");
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool JsonTranscoder::writeKey(const Item &item)
+{
+	if (item.type == Item::String || item.type == Item::Bytes)
+	{
+		return writeScalar(item);
+	}
+	if (item.type == Item::Array || item.type == Item::Map || item.type == Item::Break)
+	{
+		return false;
+	}
+
+	// Other scalars are written as they would be as values, but quoted.
+	appendText(QChar('"'));
+	writeScalar(item);
+	appendText(QChar('"'));
+	return true;
+}
+
+void JsonTranscoder::writeString(const char *data, qint64 length)
+{
+	static const char hexDigits[] = "0123456789abcdef";
+
+	QString decoded = QString::fromUtf8(data, int(length));
+	const QChar *characters = decoded.constData();
+	const int count = decoded.length();
+
+	appendText(QChar('"'));
+	int runStart = 0;
+	for (int i = 0; i < count; i++)
+	{
+		ushort c = characters[i].unicode();
+		if (c >= 0x20 && c != '"' && c != '\\')
+		{
+			continue;
+		}
+
+		// Characters that can't appear in a JSON string are escaped; everything else is copied in runs.
+		_textBuffer.append(characters + runStart, i - runStart);
+		runStart = i + 1;
+		switch (c)
+		{
+			case '"':
+				appendText("\\\"");
+				break;
+			case '\\':
+				appendText("\\\\");
+				break;
+			case '\n':
+				appendText("\\n");
+				break;
+			case '\r':
+				appendText("\\r");
+				break;
+			case '\t':
+				appendText("\\t");
+				break;
+			case '\b':
+				appendText("\\b");
+				break;
+			case '\f':
+				appendText("\\f");
+				break;
+			default:
+				appendText("\\u00");
+				appendText(QChar(hexDigits[c >> 4]));
+				appendText(QChar(hexDigits[c & 0xf]));
+				break;
+		}
+	}
+	_textBuffer.append(characters + runStart, count - runStart);
+	appendText(QChar('"'));
+}
+
+void JsonTranscoder::appendText(const QString &text)
+{
+	_textBuffer += text;
+	if (_textBuffer.length() >= TEXT_CHUNK_SIZE)
+	{
+		flushText();
+	}
+}
+
+void JsonTranscoder::appendText(QChar character)
+{
+	_textBuffer += character;
+	if (_textBuffer.length() >= TEXT_CHUNK_SIZE)
+	{
+		flushText();
+	}
+}
+
+void JsonTranscoder::flushText()
+{
+	// The index scans each chunk as it arrives, so the text is indexed by the time it is decoded.
+	_index.append(_textBuffer);
+	_textBuffer.resize(0);
+	updateProgress(_position, _size);
+}
+
+bool JsonTranscoder::exportText()
+{
+	_output.setFileName(_fileName);
+	if (!_output.open(QFile::WriteOnly))
+	{
+		_error = QString("Could not create %1: %2").arg(_fileName, _output.errorString());
+		return false;
+	}
+	_outputBuffer.reserve(OUTPUT_BUFFER_SIZE);
+
+	// The index supplies the member count of every container before its members are read.
+	_index.build(_text);
+
+	const QChar *data = _text.constData();
+	const int length = _text.length();
+	QVector<ExportFrame> stack;
+	int nextContainer = 0;
+	bool succeeded = true;
+
+	for (int i = 0; i < length && succeeded; )
+	{
+		if (_cancelled.load())
+		{
+			succeeded = fail(i, "Cancelled");
+			break;
+		}
+
+		ushort c = data[i].unicode();
+		switch (c)
+		{
+			case ' ':
+			case '\n':
+			case '\r':
+			case '\t':
+			case ',':
+			case ':':
+			case HIDDEN_CHAR:
+				i++;
+				break;
+			case '{':
+			case '[':
+			{
+				if (!beginValue(stack, i) || nextContainer >= _index.containerCount())
+				{
+					succeeded = fail(i, "Unexpected container");
+					break;
+				}
+				ExportFrame frame;
+				frame.map = c == '{';
+				frame.atKey = true;
+				frame.remaining = _index.container(nextContainer++).childCount;
+				encodeContainer(frame.map, quint64(frame.remaining));
+				stack.append(frame);
+				i++;
+				break;
+			}
+			case '}':
+			case ']':
+				// Every member counted by the index has to have been written.
+				if (stack.isEmpty() || stack.last().map != (c == '}') || stack.last().remaining != 0 || !stack.last().atKey)
+				{
+					succeeded = fail(i, "Unexpected end of container");
+					break;
+				}
+				stack.removeLast();
+				i++;
+				break;
+			case '"':
+			{
+				int end = i + 1;
+				while (end < length && data[end] != '"')
+				{
+					end += data[end] == '\\' ? 2 : 1;
+				}
+				if (end >= length)
+				{
+					succeeded = fail(i, "Unterminated string");
+					break;
+				}
+
+				if (!stack.isEmpty() && stack.last().map && stack.last().atKey)
+				{
+					if (stack.last().remaining == 0)
+					{
+						succeeded = fail(i, "Unexpected key");
+						break;
+					}
+					stack.last().remaining--;
+					stack.last().atKey = false;
+				}
+				else if (!beginValue(stack, i))
+				{
+					succeeded = fail(i, "Unexpected string");
+					break;
+				}
+
+				QByteArray utf8;
+				if (!decodeString(i + 1, end, utf8))
+				{
+					succeeded = false;
+					break;
+				}
+				encodeString(utf8);
+				i = end + 1;
+				break;
+			}
+			default:
+			{
+				int end = i;
+				while (end < length && !isDelimiter(data[end].unicode()))
+				{
+					end++;
+				}
+				if (!beginValue(stack, i))
+				{
+					succeeded = fail(i, "Unexpected value");
+					break;
+				}
+				succeeded = encodeScalar(i, end);
+				i = end;
+				break;
+			}
+		}
+
+		if (_outputBuffer.size() >= OUTPUT_BUFFER_SIZE)
+		{
+			succeeded = succeeded && flushOutput();
+			updateProgress(i, length);
+		}
+	}
+
+	if (succeeded && !stack.isEmpty())
+	{
+		succeeded = fail(length, "The document is incomplete");
+	}
+
+	succeeded = succeeded && flushOutput() && !_outputFailed;
+	if (!succeeded || !_output.commit())
+	{
+		_output.cancelWriting();
+		if (_error.isEmpty())
+		{
+			_error = QString("Could not write %1: %2").arg(_fileName, _output.errorString());
+		}
+		return false;
+	}
+	return true;
+}
+
+bool JsonTranscoder::beginValue(QVector<ExportFrame> &stack, int)
+{
+	if (stack.isEmpty())
+	{
+		return true;
+	}
+
+	ExportFrame &frame = stack.last();
+	if (frame.map)
+	{
+		if (frame.atKey)
+		{
+			return false;
+		}
+		frame.atKey = true;
+		return true;
+	}
+
+	if (frame.remaining == 0)
+	{
+		return false;
+	}
+	frame.remaining--;
+	return true;
+}
+
+bool JsonTranscoder::decodeString(int start, int end, QByteArray &utf8)
+{
+	const QChar *data = _text.constData();
+	int escape = start;
+	while (escape < end && data[escape] != '\\')
+	{
+		escape++;
+	}
+	if (escape == end)
+	{
+		utf8 = _text.midRef(start, end - start).toUtf8();
+		return true;
+	}
+
+	QString decoded;
+	decoded.reserve(end - start);
+	decoded.append(data + start, escape - start);
+	for (int i = escape; i < end; i++)
+	{
+		if (data[i] != '\\')
+		{
+			decoded += data[i];
+			continue;
+		}
+
+		if (++i >= end)
+		{
+			return fail(i, "Invalid escape sequence");
+		}
+		switch (data[i].unicode())
+		{
+			case '"':
+			case '\\':
+			case '/':
+				decoded += data[i];
+				break;
+			case 'b':
+				decoded += QChar('\b');
+				break;
+			case 'f':
+				decoded += QChar('\f');
+				break;
+			case 'n':
+				decoded += QChar('\n');
+				break;
+			case 'r':
+				decoded += QChar('\r');
+				break;
+			case 't':
+				decoded += QChar('\t');
+				break;
+			case 'u':
+			{
+				// Surrogate pairs are two escapes, and end up as a pair of UTF-16 units here.
+				bool ok = i + 4 < end;
+				ushort unit = ok ? _text.midRef(i + 1, 4).toUShort(&ok, 16) : 0;
+				if (!ok)
+				{
+					return fail(i, "Invalid unicode escape");
+				}
+				decoded += QChar(unit);
+				i += 4;
+				break;
+			}
+			default:
+				return fail(i, "Invalid escape sequence");
+		}
+	}
+	utf8 = decoded.toUtf8();
+	return true;
+}
+
+bool JsonTranscoder::encodeScalar(int start, int end)
+{
+	QStringRef token = _text.midRef(start, end - start);
+	if (token == QLatin1String("true"))
+	{
+		encodeByte(_format == Cbor ? 0xf5 : 0xc3);
+		return true;
+	}
+	if (token == QLatin1String("false"))
+	{
+		encodeByte(_format == Cbor ? 0xf4 : 0xc2);
+		return true;
+	}
+	if (token == QLatin1String("null"))
+	{
+		encodeByte(_format == Cbor ? 0xf6 : 0xc0);
+		return true;
+	}
+
+	// Integers keep their exact value when they fit; everything else becomes a double.
+	bool ok = false;
+	bool integer = !token.contains('.') && !token.contains('e') && !token.contains('E');
+	if (integer && token.startsWith('-'))
+	{
+		qint64 value = token.toLongLong(&ok);
+		if (ok)
+		{
+			encodeNegative(value);
+			return true;
+		}
+	}
+	else if (integer)
+	{
+		quint64 value = token.toULongLong(&ok);
+		if (ok)
+		{
+			encodeUnsigned(value);
+			return true;
+		}
+	}
+
+	double value = token.toDouble(&ok);
+	if (!ok || token.isEmpty() || !(token.at(0) == '-' || token.at(0).isDigit()) || !token.at(token.size() - 1).isDigit())
+	{
+		return fail(start, "Invalid value");
+	}
+	encodeDouble(value);
+	return true;
+}
+
+void JsonTranscoder::encodeContainer(bool map, quint64 count)
+{
+	if (_format == Cbor)
+	{
+		encodeCborHead(map ? 5 : 4, count);
+	}
+	else if (count < 16)
+	{
+		encodeByte(quint8((map ? 0x80 : 0x90) | count));
+	}
+	else if (count <= 0xffff)
+	{
+		encodeBigEndian(map ? 0xde : 0xdc, count, 2);
+	}
+	else
+	{
+		encodeBigEndian(map ? 0xdf : 0xdd, count, 4);
+	}
+}
+
+void JsonTranscoder::encodeString(const QByteArray &utf8)
+{
+	quint64 length = quint64(utf8.size());
+	if (_format == Cbor)
+	{
+		encodeCborHead(3, length);
+	}
+	else if (length < 32)
+	{
+		encodeByte(quint8(0xa0 | length));
+	}
+	else if (length <= 0xff)
+	{
+		encodeBigEndian(0xd9, length, 1);
+	}
+	else if (length <= 0xffff)
+	{
+		encodeBigEndian(0xda, length, 2);
+	}
+	else
+	{
+		encodeBigEndian(0xdb, length, 4);
+	}
+	_outputBuffer.append(utf8);
+}
+
+void JsonTranscoder::encodeUnsigned(quint64 value)
+{
+	if (_format == Cbor)
+	{
+		encodeCborHead(0, value);
+	}
+	else if (value <= 0x7f)
+	{
+		encodeByte(quint8(value));
+	}
+	else if (value <= 0xff)
+	{
+		encodeBigEndian(0xcc, value, 1);
+	}
+	else if (value <= 0xffff)
+	{
+		encodeBigEndian(0xcd, value, 2);
+	}
+	else if (value <= 0xffffffff)
+	{
+		encodeBigEndian(0xce, value, 4);
+	}
+	else
+	{
+		encodeBigEndian(0xcf, value, 8);
+	}
+}
+
+void JsonTranscoder::encodeNegative(qint64 value)
+{
+	if (value >= 0)
+	{
+		encodeUnsigned(quint64(value));
+	}
+	else if (_format == Cbor)
+	{
+		encodeCborHead(1, quint64(-1 - value));
+	}
+	else if (value >= -32)
+	{
+		encodeByte(quint8(value));
+	}
+	else if (value >= -128)
+	{
+		encodeBigEndian(0xd0, quint64(value), 1);
+	}
+	else if (value >= -32768)
+	{
+		encodeBigEndian(0xd1, quint64(value), 2);
+	}
+	else if (value >= Q_INT64_C(-2147483648))
+	{
+		encodeBigEndian(0xd2, quint64(value), 4);
+	}
+	else
+	{
+		encodeBigEndian(0xd3, quint64(value), 8);
+	}
+}
+
+void JsonTranscoder::encodeDouble(double value)
+{
+	quint64 bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	encodeBigEndian(_format == Cbor ? 0xfb : 0xcb, bits, 8);
+}
+
+void JsonTranscoder::encodeByte(quint8 byte)
+{
+	_outputBuffer.append(char(byte));
+}
+
+void JsonTranscoder::encodeBigEndian(quint8 head, quint64 value, int size)
+{
+	encodeByte(head);
+	for (int shift = (size - 1) * 8; shift >= 0; shift -= 8)
+	{
+		encodeByte(quint8(value >> shift));
+	}
+}
+
+void JsonTranscoder::encodeCborHead(int major, quint64 value)
+{
+	quint8 type = quint8(major << 5);
+	if (value < 24)
+	{
+		encodeByte(quint8(type | value));
+	}
+	else if (value <= 0xff)
+	{
+		encodeBigEndian(type | 24, value, 1);
+	}
+	else if (value <= 0xffff)
+	{
+		encodeBigEndian(type | 25, value, 2);
+	}
+	else if (value <= 0xffffffff)
+	{
+		encodeBigEndian(type | 26, value, 4);
+	}
+	else
+	{
+		encodeBigEndian(type | 27, value, 8);
+	}
+}
+
+bool JsonTranscoder::flushOutput()
+{
+	if (_output.write(_outputBuffer) != _outputBuffer.size())
+	{
+		_outputFailed = true;
+		return false;
+	}
+	_outputBuffer.resize(0);
+	return true;
+}
+
+void JsonTranscoder::updateProgress(qint64 done, qint64 total)
+{
+	int progress = total > 0 ? int(qMin(qint64(99), done * 100 / total)) : 0;
+	if (progress != _progress)
+	{
+		_progress = progress;
+		emit progressChanged(progress);
+	}
+}
+
+bool JsonTranscoder::fail(qint64 position, const QString &message)
+{
+	if (_error.isEmpty())
+	{
+		_error = QString("%1 at offset %2.").arg(message).arg(position);
+	}
+	return false;
+}
+
+#ifdef JSONPAD_TRANSCODER_BENCHMARK
+void JsonTranscoder::benchmarkRoundTrip()
+{
+	// The same conversion through Qt's document classes, for comparison with the streaming one above.
+	qint64 timeStart = QDateTime::currentMSecsSinceEpoch();
+	qint64 bytes = 0;
+
+	if (_direction == Import)
+	{
+		QFile file(_fileName);
+		if (!file.open(QFile::ReadOnly))
+		{
+			return;
+		}
+		QByteArray contents = file.readAll();
+		if (_format == Cbor)
+		{
+			QJsonValue value = QCborValue::fromCbor(contents).toJsonValue();
+			QJsonDocument document = value.isArray() ? QJsonDocument(value.toArray()) : QJsonDocument(value.toObject());
+			bytes = document.toJson(QJsonDocument::Compact).size();
+		}
+		else
+		{
+			// Qt has no MessagePack support, so only the JSON half of the round-trip can be compared.
+			bytes = QJsonDocument::fromJson(_index.text().toUtf8()).toJson(QJsonDocument::Compact).size();
+		}
+	}
+	else
+	{
+		QJsonDocument document = QJsonDocument::fromJson(_text.toUtf8());
+		QJsonValue value = document.isArray() ? QJsonValue(document.array()) : QJsonValue(document.object());
+		bytes = _format == Cbor ? QCborValue::fromJsonValue(value).toCbor().size() : document.toJson(QJsonDocument::Compact).size();
+	}
+
+	qDebug("time to round-trip %s through QCborValue/QJsonDocument: %lld ms (%lld bytes)", qPrintable(formatName(_format)),
+		   QDateTime::currentMSecsSinceEpoch() - timeStart, bytes);
+}
+#endif
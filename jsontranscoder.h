@@ -0,0 +1,168 @@
+/**
+ * @file jsontranscoder.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Streaming conversion between JSON text and CBOR or MessagePack files.
+ */
+#ifndef JSONTRANSCODER_H
+#define JSONTRANSCODER_H
+
+#include <QThread>
+#include <QVector>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QSaveFile>
+#include "jsonstructureindex.h"
+
+/**
+ * Imports decode the memory-mapped file item by item straight into JSON text, which is
+ * fed to a structure index in chunks as it is produced, so the editor receives the text
+ * already indexed.  Exports index the text first and walk it token by token; the index
+ * supplies the member count of each container up front, so both formats are written
+ * with definite lengths and without building a document tree.
+ *
+ * Byte strings become base64url strings, tags are dropped, non-string map keys become
+ * strings and values without a JSON equivalent (undefined, NaN, infinities) become null.
+ * A file holding several values in a row is shown one value per line.
+ */
+class JsonTranscoder : public QThread
+{
+	Q_OBJECT
+
+public:
+	enum Format
+	{
+		Json,
+		Cbor,
+		MessagePack
+	};
+
+	enum Direction
+	{
+		Import,
+		Export
+	};
+
+	JsonTranscoder(Direction direction, const QString &fileName, Format format, QObject *parent = nullptr);
+	virtual ~JsonTranscoder();
+
+	static Format formatForFile(const QString &fileName);
+	static QString formatName(Format format);
+
+	void setText(const QString &text);
+	const JsonStructureIndex &index() const;
+
+	bool succeeded() const;
+	bool wasCancelled() const;
+	QString errorString() const;
+
+public slots:
+	void cancel();
+
+signals:
+	void progressChanged(int percent);
+
+protected:
+	virtual void run();
+
+private:
+	struct Item
+	{
+		enum Type
+		{
+			Unsigned,
+			Negative,			///< The value is -1 - number, as CBOR stores it.
+			Float,
+			Double,
+			String,
+			Bytes,
+			True,
+			False,
+			Null,
+			Array,
+			Map,
+			Break
+		};
+
+		Type type;
+		quint64 number;
+		double real;
+		qint64 count;			///< Number of elements or pairs, or -1 if the length is indefinite.
+		const char *data;
+		qint64 length;
+	};
+
+	struct ImportFrame
+	{
+		bool map;
+		bool first;
+		bool atKey;
+		qint64 remaining;
+	};
+
+	struct ExportFrame
+	{
+		bool map;
+		bool atKey;
+		qint64 remaining;
+	};
+
+	bool importFile();
+	bool readItem(Item &item);
+	bool readCborItem(Item &item);
+	bool readMessagePackItem(Item &item);
+	bool readBytes(qint64 length, Item &item);
+	bool readBigEndian(int size, quint64 &value);
+	bool writeScalar(const Item &item);
+	bool writeKey(const Item &item);
+	void writeString(const char *data, qint64 length);
+	void appendText(const QString &text);
+	void appendText(QChar character);
+	void flushText();
+
+	bool exportText();
+	bool beginValue(QVector<ExportFrame> &stack, int position);
+	bool decodeString(int start, int end, QByteArray &utf8);
+	bool encodeScalar(int start, int end);
+	void encodeContainer(bool map, quint64 count);
+	void encodeString(const QByteArray &utf8);
+	void encodeUnsigned(quint64 value);
+	void encodeNegative(qint64 value);
+	void encodeDouble(double value);
+	void encodeByte(quint8 byte);
+	void encodeBigEndian(quint8 head, quint64 value, int size);
+	void encodeCborHead(int major, quint64 value);
+	bool flushOutput();
+
+	void updateProgress(qint64 done, qint64 total);
+	bool fail(qint64 position, const QString &message);
+
+#ifdef JSONPAD_TRANSCODER_BENCHMARK
+	void benchmarkRoundTrip();
+#endif
+
+	Direction _direction;
+	QString _fileName;
+	Format _format;
+
+	JsonStructureIndex _index;
+	QString _text;
+	QString _textBuffer;
+
+	const char *_data;
+	qint64 _size;
+	qint64 _position;
+	QByteArray _chunks;
+
+	QSaveFile _output;
+	QByteArray _outputBuffer;
+	bool _outputFailed;
+	int _progress;
+
+	QAtomicInt _cancelled;
+	bool _succeeded;
+	QString _error;
+};
+
+#endif // JSONTRANSCODER_H
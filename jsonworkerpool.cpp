@@ -0,0 +1,187 @@
+/**
+ * @file jsonworkerpool.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "jsonworkerpool.h"
+
+JsonWorkerPool &JsonWorkerPool::instance()
+{
+	static JsonWorkerPool pool;
+	return pool;
+}
+
+JsonWorkerPool::JsonWorkerPool() :
+	_queuedJobs(0),
+	_nextQueue(0),
+	_stopping(false)
+{
+	// The thread that submits a batch works on it too, so it gets no worker of its own.
+	int count = qBound(1, QThread::idealThreadCount() - 1, int(MaximumWorkers));
+	for (int i = 0; i < count; i++)
+	{
+		_queues.append(new Queue);
+	}
+	for (int i = 0; i < count; i++)
+	{
+		Worker *worker = new Worker(this, i);
+		_workers.append(worker);
+		worker->start();
+	}
+}
+
+JsonWorkerPool::~JsonWorkerPool()
+{
+	_idleMutex.lock();
+	_stopping = true;
+	_jobsAvailable.wakeAll();
+	_idleMutex.unlock();
+
+	for (int i = 0; i < _workers.count(); i++)
+	{
+		_workers.at(i)->wait();
+		delete _workers.at(i);
+	}
+	qDeleteAll(_queues);
+}
+
+int JsonWorkerPool::workerCount() const
+{
+	return _workers.count();
+}
+
+void JsonWorkerPool::run(const QVector<Task> &tasks)
+{
+	if (tasks.count() <= 1)
+	{
+		for (int i = 0; i < tasks.count(); i++)
+		{
+			tasks.at(i)();
+		}
+		return;
+	}
+
+	Batch batch;
+	batch.remaining.store(tasks.count());
+
+	for (int i = 0; i < tasks.count(); i++)
+	{
+		if (_queuedJobs.load() >= MaximumQueuedTasks)
+		{
+			// The pool is saturated, so the submitting thread does the work itself.
+			tasks.at(i)();
+			batch.remaining.deref();
+			continue;
+		}
+
+		Queue *queue = _queues.at(int(uint(_nextQueue.fetchAndAddRelaxed(1)) % uint(_queues.count())));
+		Job job;
+		job.task = tasks.at(i);
+		job.batch = &batch;
+
+		queue->mutex.lock();
+		queue->jobs.push_back(job);
+		queue->mutex.unlock();
+		_queuedJobs.ref();
+	}
+
+	_idleMutex.lock();
+	_jobsAvailable.wakeAll();
+	_idleMutex.unlock();
+
+	while (batch.remaining.load() > 0)
+	{
+		Job job;
+		if (takeJob(-1, job))
+		{
+			execute(job);
+			continue;
+		}
+
+		// Everything left is already running on a worker.
+		_idleMutex.lock();
+		if (batch.remaining.load() > 0)
+		{
+			_batchFinished.wait(&_idleMutex);
+		}
+		_idleMutex.unlock();
+	}
+}
+
+bool JsonWorkerPool::takeJob(int ownQueue, Job &job)
+{
+	if (ownQueue >= 0)
+	{
+		// The newest task in a worker's own queue is the one most likely to still be in cache.
+		Queue *queue = _queues.at(ownQueue);
+		QMutexLocker locker(&queue->mutex);
+		if (!queue->jobs.empty())
+		{
+			job = queue->jobs.back();
+			queue->jobs.pop_back();
+			_queuedJobs.deref();
+			return true;
+		}
+	}
+
+	// Steal the oldest task from another queue.
+	for (int i = 1; i <= _queues.count(); i++)
+	{
+		Queue *queue = _queues.at((qMax(ownQueue, 0) + i) % _queues.count());
+		QMutexLocker locker(&queue->mutex);
+		if (!queue->jobs.empty())
+		{
+			job = queue->jobs.front();
+			queue->jobs.pop_front();
+			_queuedJobs.deref();
+			return true;
+		}
+	}
+	return false;
+}
+
+void JsonWorkerPool::execute(Job &job)
+{
+	job.task();
+
+	// The batch belongs to the submitting thread and can be gone as soon as it is finished.
+	if (!job.batch->remaining.deref())
+	{
+		_idleMutex.lock();
+		_batchFinished.wakeAll();
+		_idleMutex.unlock();
+	}
+}
+
+JsonWorkerPool::Worker::Worker(JsonWorkerPool *pool, int queue) :
+	_pool(pool),
+	_queue(queue)
+{
+}
+
+void JsonWorkerPool::Worker::run()
+{
+	while (true)
+	{
+		Job job;
+		if (_pool->takeJob(_queue, job))
+		{
+			_pool->execute(job);
+			continue;
+		}
+
+		_pool->_idleMutex.lock();
+		if (_pool->_stopping)
+		{
+			_pool->_idleMutex.unlock();
+			return;
+		}
+		if (_pool->_queuedJobs.load() == 0)
+		{
+			_pool->_jobsAvailable.wait(&_pool->_idleMutex);
+		}
+		_pool->_idleMutex.unlock();
+	}
+}
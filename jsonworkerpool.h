@@ -0,0 +1,91 @@
+/**
+ * @file jsonworkerpool.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Bounded work-stealing thread pool shared by every open document.
+ */
+#ifndef JSONWORKERPOOL_H
+#define JSONWORKERPOOL_H
+
+#include <QThread>
+#include <QVector>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <deque>
+#include <functional>
+
+/**
+ * Every worker owns a queue.  A batch of tasks is dealt out across the queues; workers
+ * take the newest task from their own queue and steal the oldest from the others once
+ * theirs is empty, so a batch of uneven tasks still keeps every worker busy.  The thread
+ * that submits a batch steals tasks too until the batch is done, which means tasks can
+ * submit batches of their own without tying up the pool.
+ *
+ * The pool has one worker fewer than there are cores and never more than
+ * MaximumWorkers, and once MaximumQueuedTasks are waiting, further tasks are run on the
+ * submitting thread instead of being queued.
+ */
+class JsonWorkerPool
+{
+public:
+	typedef std::function<void()> Task;
+
+	static const int MaximumWorkers = 8;
+	static const int MaximumQueuedTasks = 1024;
+
+	static JsonWorkerPool &instance();
+
+	int workerCount() const;
+	void run(const QVector<Task> &tasks);
+
+private:
+	struct Batch
+	{
+		QAtomicInt remaining;
+	};
+
+	struct Job
+	{
+		Task task;
+		Batch *batch;
+	};
+
+	struct Queue
+	{
+		QMutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	class Worker : public QThread
+	{
+	public:
+		Worker(JsonWorkerPool *pool, int queue);
+
+	protected:
+		virtual void run();
+
+	private:
+		JsonWorkerPool *_pool;
+		int _queue;
+	};
+
+	JsonWorkerPool();
+	~JsonWorkerPool();
+
+	bool takeJob(int ownQueue, Job &job);
+	void execute(Job &job);
+
+	QVector<Queue *> _queues;
+	QVector<Worker *> _workers;
+	QAtomicInt _queuedJobs;
+	QAtomicInt _nextQueue;
+
+	QMutex _idleMutex;
+	QWaitCondition _jobsAvailable;
+	QWaitCondition _batchFinished;
+	bool _stopping;
+};
+
+#endif // JSONWORKERPOOL_H
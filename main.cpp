@@ -6,13 +6,45 @@
  * @brief
  */
 #include "mainwindow.h"
+#include "jsonfileloader.h"
+#include "jsonstartuptrace.h"
 #include <QApplication>
+#include <QCommandLineParser>
 
 int main(int argc, char *argv[])
 {
+	JsonStartupTrace::start();
+
 	QApplication a(argc, argv);
+	a.setOrganizationName("JSONPad");
+	a.setApplicationName("JSONPad");
+
+	QCommandLineParser parser;
+	parser.addHelpOption();
+	QCommandLineOption memoryReportOption("memory-report", "Print the memory each file takes, unformatted and formatted, then exit.");
+	parser.addOption(memoryReportOption);
+	parser.addPositionalArgument("files", "JSON files to open.", "[files...]");
+	parser.process(a);
+
+	if (parser.isSet(memoryReportOption))
+	{
+		return MainWindow::printMemoryReport(parser.positionalArguments());
+	}
+
+	// Files are read and indexed while the window is being built.
+	JsonFileLoader *loader = NULL;
+	if (!parser.positionalArguments().isEmpty())
+	{
+		loader = new JsonFileLoader(parser.positionalArguments());
+		loader->start();
+	}
+
 	MainWindow w;
 	w.show();
+	if (loader != NULL)
+	{
+		w.openFiles(loader);
+	}
 
 	return a.exec();
 }
@@ -11,28 +11,100 @@
 #include <QMessageBox>
 #include <QCloseEvent>
 #include <QJsonDocument>
+#include <QDockWidget>
+#include <QTreeView>
+#include <QHeaderView>
+#include <QInputDialog>
+#include <QLabel>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QTimer>
+#include <QProgressDialog>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QVBoxLayout>
+#include "jsoneditor.h"
+#include "jsondocumenttab.h"
+#include "jsonoutlinemodel.h"
+#include "jsondiffdialog.h"
+#include "preferencesdialog.h"
+#include "jsonjournal.h"
+#include "jsoncanonicalizer.h"
+#include "jsontranscoder.h"
+#include "jsonquery.h"
+#include "memoryusagedialog.h"
+#include "jsonfileloader.h"
+#include "jsonstartuptrace.h"
+#include <QTextStream>
+
+// Formatted text and layout kept for documents in the background before the least
+// recently shown of them are dropped; the document being shown always keeps its own.
+#define DERIVED_DATA_BUDGET		(256 * 1024 * 1024)
+
+// Query results listed at most, and how much of each value is shown next to its path.
+#define MAXIMUM_LISTED_RESULTS	10000
+#define RESULT_PREVIEW_LENGTH	80
+
+// Milliseconds from launch to a file named on the command line being on screen.
+#define FIRST_CONTENT_BUDGET	150
+
+static inline QString documentMode(const JsonEditor *editor)
+{
+	if (editor->isDerivedDataReleased())
+	{
+		return "Released";
+	}
+
+	// Every level past the full view has given up undo.
+	QString mode = editor->isFormatted() ? "Formatted" : "Raw";
+	if (editor->degradeLevel() != JsonEditor::FullView)
+	{
+		mode += " (over cap, no undo)";
+	}
+	return mode;
+}
 
 MainWindow::MainWindow(QWidget *parent) :
 	QMainWindow(parent),
 	ui(new Ui::MainWindow),
-	_unsavedChanges(false)
+	_outlineModel(NULL),
+	_outlineView(NULL),
+	_synchronizingOutline(false),
+	_queryEdit(NULL),
+	_queryResults(NULL),
+	_pathLabel(NULL),
+	_fileLoader(NULL)
 {
 	ui->setupUi(this);
 	setWindowIcon(QIcon::fromTheme("emblem-documents"));
 
-	connect(ui->centralWidget, &JsonEditor::textChanged, this, &MainWindow::documentChanged);
 	connect(ui->actionNew, &QAction::triggered, this, &MainWindow::newDocument);
 	connect(ui->actionOpen, &QAction::triggered, this, &MainWindow::openDocument);
 	connect(ui->actionSave, &QAction::triggered, this, &MainWindow::save);
 	connect(ui->actionSaveAs, &QAction::triggered, this, &MainWindow::saveAs);
-	connect(ui->actionUndo, &QAction::triggered, ui->centralWidget, &JsonEditor::undo);
-	connect(ui->actionRedo, &QAction::triggered, ui->centralWidget, &JsonEditor::redo);
-	connect(ui->centralWidget, &JsonEditor::undoAvailable, ui->actionUndo, &QAction::setEnabled);
-	connect(ui->centralWidget, &JsonEditor::redoAvailable, ui->actionRedo, &QAction::setEnabled);
-	connect(ui->actionFormat, &QAction::triggered, ui->centralWidget, &JsonEditor::setFormatted);
-	connect(ui->centralWidget, &JsonEditor::documentFormatted, ui->actionFormat, &QAction::setChecked);
+	connect(ui->actionClose, &QAction::triggered, this, &MainWindow::closeDocument);
 
-	updateWindowTitle();
+	// The actions always apply to the document being shown.
+	connect(ui->actionUndo, &QAction::triggered, this, [this]() { editor()->undo(); });
+	connect(ui->actionRedo, &QAction::triggered, this, [this]() { editor()->redo(); });
+	connect(ui->actionFormat, &QAction::triggered, this, [this](bool formatted) { editor()->setFormatted(formatted); });
+	connect(ui->actionFold_All, &QAction::triggered, this, [this]() { editor()->foldAll(); });
+	connect(ui->actionUnfold_All, &QAction::triggered, this, [this]() { editor()->unfoldAll(); });
+
+	connect(ui->documentTabs, &QTabWidget::currentChanged, this, &MainWindow::currentTabChanged);
+	connect(ui->documentTabs, &QTabWidget::tabCloseRequested, this, &MainWindow::closeTab);
+
+	_pathLabel = new QLabel(this);
+	_pathLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+	ui->statusBar->addPermanentWidget(_pathLabel, 1);
+
+	newDocument();
+
+	// The docks start hidden, so they are only built once the window is up, along with asking about recovery.
+	QTimer::singleShot(0, this, &MainWindow::createDeferredWidgets);
+	QTimer::singleShot(0, this, &MainWindow::recoverSession);
+	JsonStartupTrace::markOnPaint(this, "first paint");
 }
 
 MainWindow::~MainWindow()
@@ -42,41 +114,303 @@ MainWindow::~MainWindow()
 
 void MainWindow::newDocument()
 {
-	closeDocument();
+	ui->documentTabs->setCurrentWidget(addDocumentTab());
+}
+
+JsonDocumentTab *MainWindow::addDocumentTab()
+{
+	JsonDocumentTab *tab = new JsonDocumentTab(ui->documentTabs);
+	JsonEditor *tabEditor = tab->editor();
+	tabEditor->setFormatStyle(JsonFormatStyle::load());
+	tabEditor->setMemoryCap(JsonMemoryUsage::documentCap());
+	if (ui->actionFormat->isChecked())
+	{
+		tabEditor->setFormatted(true);
+	}
+
+	// Every document reports to the window, which only listens to the one being shown.
+	connect(tabEditor, &JsonEditor::undoAvailable, this, [this, tab](bool available)
+	{
+		if (tab == currentTab())
+		{
+			ui->actionUndo->setEnabled(available);
+		}
+	});
+	connect(tabEditor, &JsonEditor::redoAvailable, this, [this, tab](bool available)
+	{
+		if (tab == currentTab())
+		{
+			ui->actionRedo->setEnabled(available);
+		}
+	});
+	connect(tabEditor, &JsonEditor::documentFormatted, this, [this, tab](bool formatted)
+	{
+		if (tab == currentTab())
+		{
+			ui->actionFormat->setChecked(formatted);
+		}
+	});
+	connect(tabEditor, &JsonEditor::degraded, this, [this, tab](JsonEditor::DegradeLevel level)
+	{
+		ui->statusBar->showMessage(QString("%1 is over its memory cap; %2.").arg(tab->title(),
+								   level == JsonEditor::WithoutUndo ? "undo history is no longer kept" : "showing the raw text"), 5000);
+		if (tab == currentTab())
+		{
+			ui->actionUndo->setEnabled(false);
+			ui->actionRedo->setEnabled(false);
+			ui->actionFormat->setChecked(tab->editor()->isFormatted());
+		}
+	});
+	connect(tabEditor, &JsonEditor::rawCursorPositionChanged, this, [this, tab](int position)
+	{
+		if (tab == currentTab())
+		{
+			updatePathLabel(position);
+			outlineFollowCursor(position);
+		}
+	});
+	connect(tabEditor, &JsonEditor::structureIndexChanged, this, [this, tab]()
+	{
+		if (tab == currentTab())
+		{
+			outlineIndexChanged();
+			clearQueryResults();
+		}
+	});
+	connect(tab, &JsonDocumentTab::titleChanged, this, [this, tab]()
+	{
+		int index = ui->documentTabs->indexOf(tab);
+		ui->documentTabs->setTabText(index, tab->title());
+		ui->documentTabs->setTabToolTip(index, tab->fileName());
+		if (tab == currentTab())
+		{
+			updateWindowTitle();
+		}
+	});
+
+	ui->documentTabs->addTab(tab, tab->title());
+	return tab;
+}
+
+JsonDocumentTab *MainWindow::documentTabForOpening()
+{
+	// An untouched new document is replaced rather than left behind.
+	if (currentTab() != NULL && currentTab()->isEmpty())
+	{
+		return currentTab();
+	}
+	return addDocumentTab();
+}
+
+JsonDocumentTab *MainWindow::currentTab() const
+{
+	return qobject_cast<JsonDocumentTab *>(ui->documentTabs->currentWidget());
+}
+
+JsonEditor *MainWindow::editor() const
+{
+	return currentTab()->editor();
+}
+
+void MainWindow::currentTabChanged()
+{
+	JsonDocumentTab *tab = currentTab();
+	if (tab == NULL)
+	{
+		return;
+	}
+
+	_recentTabs.removeOne(tab);
+	_recentTabs.prepend(tab);
+	tab->editor()->restoreDerivedData();
+
+	ui->actionUndo->setEnabled(tab->editor()->document()->isUndoAvailable());
+	ui->actionRedo->setEnabled(tab->editor()->document()->isRedoAvailable());
+	ui->actionFormat->setChecked(tab->editor()->isFormatted());
+	ui->actionFollow_File->setChecked(tab->isFollowing());
+
+	updateWindowTitle();
+	updatePathLabel(tab->editor()->rawCursorPosition());
+	outlineIndexChanged();
+	clearQueryResults();
+
+	enforceMemoryBudget();
+}
+
+void MainWindow::enforceMemoryBudget()
+{
+	qint64 total = 0;
+	for (int i = 0; i < _recentTabs.count(); i++)
+	{
+		total += _recentTabs.at(i)->editor()->derivedDataSize();
+	}
+
+	// The raw text and structure index stay, so a dropped view is rebuilt when its tab is shown again.
+	for (int i = _recentTabs.count() - 1; i > 0 && total > DERIVED_DATA_BUDGET; i--)
+	{
+		JsonEditor *tabEditor = _recentTabs.at(i)->editor();
+		qint64 size = tabEditor->derivedDataSize();
+		if (size > 0)
+		{
+			tabEditor->releaseDerivedData();
+			total -= size;
+		}
+	}
 }
 
 bool MainWindow::openDocument()
 {
-	QString selectedFilename = QFileDialog::getOpenFileName(this, "Select a JSON file to open.");
+	QStringList selectedFilenames = QFileDialog::getOpenFileNames(this, "Select JSON files to open.");
+	if (selectedFilenames.isEmpty())
+	{
+		return false;
+	}
 
-	if (!selectedFilename.isEmpty())
+	bool opened = false;
+	QVector<JsonDocumentTab::Contents> contents;
+	foreach (const QString &selectedFilename, selectedFilenames)
 	{
-		QFile selectedFile(selectedFilename);
-		if (!selectedFile.open(QFile::ReadOnly))
+		if (JsonTranscoder::formatForFile(selectedFilename) == JsonTranscoder::Json)
 		{
-			// Could not open the file for some reason!
-			return false;
+			JsonDocumentTab::Contents file;
+			file.fileName = selectedFilename;
+			file.size = 0;
+			file.loaded = false;
+			contents.append(file);
+			continue;
 		}
+		opened |= openTranscodedFile(selectedFilename);
+	}
 
-		ui->centralWidget->setText(selectedFile.readAll());
-		selectedFile.close();
+	JsonDocumentTab::loadAll(contents);
+	opened |= showContents(contents);
+	return opened;
+}
 
-		_currentDocument.setFileName(selectedFilename);
-		_unsavedChanges = false;
-		updateWindowTitle();
-		return true;
+void MainWindow::openFiles(JsonFileLoader *loader)
+{
+	// The loader was started before the window was built, and may well be done already.
+	_fileLoader = loader;
+	_fileLoader->setParent(this);
+	connect(_fileLoader, &JsonFileLoader::loaded, this, &MainWindow::showLoadedFiles);
+	if (_fileLoader->isLoaded())
+	{
+		QTimer::singleShot(0, this, &MainWindow::showLoadedFiles);
 	}
-	else
+}
+
+void MainWindow::showLoadedFiles()
+{
+	if (_fileLoader == NULL)
+	{
+		return;
+	}
+
+	JsonFileLoader *loader = _fileLoader;
+	_fileLoader = NULL;
+
+	// The editor is timed from the moment it has something to show.
+	if (showContents(loader->contents()))
+	{
+		JsonStartupTrace::markOnPaint(editor()->viewport(), "first content", FIRST_CONTENT_BUDGET);
+		if (editor()->isFormatted())
+		{
+			JsonStartupTrace::markOnPaint(editor()->viewport(), "formatted view");
+		}
+	}
+
+	foreach (const QString &fileName, loader->fileNames())
+	{
+		if (JsonTranscoder::formatForFile(fileName) != JsonTranscoder::Json)
+		{
+			openTranscodedFile(fileName);
+		}
+	}
+	loader->deleteLater();
+}
+
+bool MainWindow::openTranscodedFile(const QString &fileName)
+{
+	// Binary files are decoded and indexed in one pass on a worker thread.
+	JsonTranscoder importer(JsonTranscoder::Import, fileName, JsonTranscoder::formatForFile(fileName));
+	if (!runTranscoder(importer, QString("Reading %1...").arg(QFileInfo(fileName).fileName())))
 	{
 		return false;
 	}
+
+	JsonDocumentTab *tab = documentTabForOpening();
+	tab->editor()->setIndexedText(importer.index());
+
+	// Edits can't be replayed against the binary file, so the journal starts from the decoded text.
+	tab->journal()->resetToText(importer.index().text());
+	tab->setFollowOffset(0);
+	tab->setFileName(fileName);
+	tab->setUnsavedChanges(false);
+	ui->documentTabs->setCurrentWidget(tab);
+	enforceMemoryBudget();
+	return true;
+}
+
+bool MainWindow::showContents(QVector<JsonDocumentTab::Contents> &contents)
+{
+	bool opened = false;
+	for (int i = 0; i < contents.count(); i++)
+	{
+		if (!contents.at(i).loaded)
+		{
+			ui->statusBar->showMessage(QString("Could not read %1").arg(contents.at(i).fileName), 3000);
+			continue;
+		}
+
+		JsonDocumentTab *tab = documentTabForOpening();
+		tab->setContents(contents.at(i));
+		ui->documentTabs->setCurrentWidget(tab);
+		contents[i].index.clear();
+		opened = true;
+	}
+
+	enforceMemoryBudget();
+	return opened;
 }
 
 bool MainWindow::closeDocument()
 {
-	if (_unsavedChanges)
+	return closeDocumentTab(currentTab());
+}
+
+void MainWindow::closeTab(int index)
+{
+	closeDocumentTab(qobject_cast<JsonDocumentTab *>(ui->documentTabs->widget(index)));
+}
+
+bool MainWindow::closeDocumentTab(JsonDocumentTab *tab)
+{
+	if (tab == NULL || !confirmClose(tab))
+	{
+		return false;
+	}
+
+	// There is always a document to show.
+	if (ui->documentTabs->count() == 1)
+	{
+		newDocument();
+	}
+
+	tab->setFollowing(false);
+	tab->saveFoldState();
+	tab->journal()->discard();
+	_recentTabs.removeOne(tab);
+	ui->documentTabs->removeTab(ui->documentTabs->indexOf(tab));
+	tab->deleteLater();
+	return true;
+}
+
+bool MainWindow::confirmClose(JsonDocumentTab *tab)
+{
+	if (tab->hasUnsavedChanges())
 	{
-		switch(QMessageBox::warning(this, "There are unsaved changes!", "Would you like to save your changes before closing?", QMessageBox::Save, QMessageBox::Discard, QMessageBox::Cancel))
+		ui->documentTabs->setCurrentWidget(tab);
+		switch(QMessageBox::warning(this, "There are unsaved changes!", QString("Would you like to save your changes to %1 before closing?").arg(tab->title().mid(1)), QMessageBox::Save, QMessageBox::Discard, QMessageBox::Cancel))
 		{
 			case QMessageBox::Cancel:
 				return false;
@@ -91,17 +425,12 @@ bool MainWindow::closeDocument()
 				break;
 		}
 	}
-
-	ui->centralWidget->clear();
-	_currentDocument.setFileName("");
-	_unsavedChanges = false;
-	updateWindowTitle();
 	return true;
 }
 
 bool MainWindow::save()
 {
-	if (_currentDocument.fileName().isEmpty())
+	if (currentTab()->fileName().isEmpty())
 	{
 		return saveAs();
 	}
@@ -115,7 +444,7 @@ bool MainWindow::saveAs()
 
 	if (!saveFilename.isEmpty())
 	{
-		_currentDocument.setFileName(saveFilename);
+		currentTab()->setFileName(saveFilename);
 	}
 
 	return saveDocument();
@@ -123,30 +452,32 @@ bool MainWindow::saveAs()
 
 void MainWindow::closeEvent(QCloseEvent *event)
 {
-	if (_unsavedChanges && !closeDocument())
+	for (int i = 0; i < ui->documentTabs->count(); i++)
 	{
-		event->ignore();
+		if (!confirmClose(qobject_cast<JsonDocumentTab *>(ui->documentTabs->widget(i))))
+		{
+			event->ignore();
+			return;
+		}
 	}
-	else
+
+	for (int i = 0; i < ui->documentTabs->count(); i++)
 	{
-		event->accept();
+		JsonDocumentTab *tab = qobject_cast<JsonDocumentTab *>(ui->documentTabs->widget(i));
+		tab->saveFoldState();
+		tab->journal()->discard();
 	}
-}
-
-void MainWindow::documentChanged()
-{
-	_unsavedChanges = true;
-	updateWindowTitle();
+	event->accept();
 }
 
 void MainWindow::updateWindowTitle()
 {
-	QString documentName = _currentDocument.fileName();
+	QString documentName = currentTab()->fileName();
 	if (documentName.isEmpty())
 	{
 		documentName = "New Document";
 	}
-	if (_unsavedChanges)
+	if (currentTab()->hasUnsavedChanges())
 	{
 		documentName = "*" + documentName;
 	}
@@ -155,27 +486,84 @@ void MainWindow::updateWindowTitle()
 
 bool MainWindow::saveDocument()
 {
-	if (!_currentDocument.open(QFile::WriteOnly))
+	JsonDocumentTab *tab = currentTab();
+	QFile document(tab->fileName());
+
+	// Fold markers only exist in the editor.
+	QString text = tab->editor()->text();
+	text.remove(QChar(HIDDEN_CHAR));
+
+	JsonTranscoder::Format format = JsonTranscoder::formatForFile(document.fileName());
+	if (format != JsonTranscoder::Json)
+	{
+		JsonTranscoder exporter(JsonTranscoder::Export, document.fileName(), format);
+		exporter.setText(text);
+		if (!runTranscoder(exporter, QString("Writing %1...").arg(QFileInfo(document).fileName())))
+		{
+			return false;
+		}
+
+		tab->journal()->resetToText(text);
+		tab->setUnsavedChanges(false);
+		return true;
+	}
+
+	if (!document.open(QFile::WriteOnly))
 	{
 		// Could not open the file to write.
 		return false;
 	}
 
-	if (!ui->centralWidget->text().isEmpty())
+	if (!text.isEmpty())
 	{
-
-		_currentDocument.write(ui->centralWidget->text().toUtf8().data());
+		document.write(text.toUtf8());
 	}
 
-	_currentDocument.close();
-	_unsavedChanges = false;
-	updateWindowTitle();
+	document.close();
+	tab->journal()->resetToFile(document.fileName());
+	tab->setUnsavedChanges(false);
 	return true;
 }
 
+bool MainWindow::runTranscoder(JsonTranscoder &transcoder, const QString &label)
+{
+	QProgressDialog progress(label, "Cancel", 0, 100, this);
+	progress.setWindowModality(Qt::WindowModal);
+	progress.setMinimumDuration(500);
+	connect(&transcoder, &JsonTranscoder::progressChanged, &progress, &QProgressDialog::setValue);
+	connect(&progress, &QProgressDialog::canceled, &transcoder, &JsonTranscoder::cancel);
+	connect(&transcoder, &QThread::finished, &progress, &QProgressDialog::accept);
+
+	transcoder.start();
+	progress.exec();
+	transcoder.wait();
+
+	if (!transcoder.succeeded() && !transcoder.wasCancelled())
+	{
+		QMessageBox::warning(this, "Could not convert the document", transcoder.errorString());
+	}
+	return transcoder.succeeded();
+}
+
 void MainWindow::on_actionPreferences_triggered()
 {
-	/// TODO: Show preferences window.
+	PreferencesDialog dialog(this);
+	dialog.setFormatStyle(editor()->formatStyle());
+	dialog.setMemoryCap(JsonMemoryUsage::documentCap());
+	if (dialog.exec() == QDialog::Accepted)
+	{
+		JsonFormatStyle style = dialog.formatStyle();
+		style.save();
+		JsonMemoryUsage::setDocumentCap(dialog.memoryCap());
+
+		// Documents in the background only take the style now and are formatted when shown.
+		for (int i = 0; i < ui->documentTabs->count(); i++)
+		{
+			JsonEditor *tabEditor = qobject_cast<JsonDocumentTab *>(ui->documentTabs->widget(i))->editor();
+			tabEditor->setFormatStyle(style);
+			tabEditor->setMemoryCap(dialog.memoryCap());
+		}
+	}
 }
 
 void MainWindow::on_actionFormat_JSON_triggered()
@@ -184,5 +572,405 @@ void MainWindow::on_actionFormat_JSON_triggered()
 
 void MainWindow::on_actionCompress_JSON_triggered()
 {
-	ui->centralWidget->setText(QJsonDocument::fromJson(ui->centralWidget->text().toLatin1()).toJson(QJsonDocument::Compact));
+	editor()->setText(QJsonDocument::fromJson(editor()->text().toLatin1()).toJson(QJsonDocument::Compact));
+	currentTab()->journal()->resetToText(editor()->text());
+}
+
+void MainWindow::recoverSession()
+{
+	// Every document of the last session left a journal of its own.
+	QStringList paths;
+	QStringList texts;
+	QString path;
+	QString text;
+	while (JsonJournal::recover(path, text))
+	{
+		if (!path.isEmpty() || !text.isEmpty())
+		{
+			paths.append(path);
+			texts.append(text);
+		}
+	}
+
+	if (texts.isEmpty() ||
+		QMessageBox::question(this, "Recover unsaved changes?", "JSONPad did not shut down cleanly. Would you like to recover your unsaved changes?",
+							  QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes)
+	{
+		return;
+	}
+
+	for (int i = 0; i < texts.count(); i++)
+	{
+		JsonDocumentTab *tab = documentTabForOpening();
+		tab->editor()->setText(texts.at(i));
+		tab->journal()->resetToText(tab->editor()->text());
+		tab->setFileName(paths.at(i));
+		tab->setUnsavedChanges(true);
+		ui->documentTabs->setCurrentWidget(tab);
+	}
+	enforceMemoryBudget();
+}
+
+void MainWindow::on_actionGo_to_Path_triggered()
+{
+	bool accepted;
+	QString path = QInputDialog::getText(this, "Go to Path", "JSONPath or JSON Pointer:", QLineEdit::Normal, _pathLabel->text(), &accepted);
+	if (!accepted)
+	{
+		return;
+	}
+
+	int offset = editor()->structureIndex().offsetForPath(path);
+	if (offset == -1)
+	{
+		ui->statusBar->showMessage(QString("No value found at %1").arg(path), 3000);
+		return;
+	}
+	editor()->setRawCursorPosition(offset);
+}
+
+void MainWindow::on_actionFold_to_Depth_triggered()
+{
+	bool accepted;
+	int depth = QInputDialog::getInt(this, "Fold to Depth", "Collapse objects nested at or below depth:", 1, 0, 1000, 1, &accepted);
+	if (accepted)
+	{
+		editor()->foldToDepth(depth);
+	}
+}
+
+void MainWindow::on_actionCompare_With_triggered()
+{
+	QString selectedFilename = QFileDialog::getOpenFileName(this, "Select a JSON file to compare with.");
+	if (selectedFilename.isEmpty())
+	{
+		return;
+	}
+
+	QFile selectedFile(selectedFilename);
+	if (!selectedFile.open(QFile::ReadOnly))
+	{
+		return;
+	}
+
+	QString documentName = currentTab()->fileName().isEmpty() ? QString("New Document") : QFileInfo(currentTab()->fileName()).fileName();
+
+	JsonDiffDialog *dialog = new JsonDiffDialog(this);
+	dialog->setAttribute(Qt::WA_DeleteOnClose);
+	dialog->compare(documentName, editor()->text(), QFileInfo(selectedFile).fileName(), selectedFile.readAll());
+	dialog->show();
+}
+
+void MainWindow::on_actionSave_Canonical_Copy_triggered()
+{
+	// The canonicalizer streams from the file on disk, so it has to match what is shown.
+	if (currentTab()->fileName().isEmpty() || currentTab()->hasUnsavedChanges())
+	{
+		ui->statusBar->showMessage("Save the document before making a canonical copy of it.", 3000);
+		return;
+	}
+	if (JsonTranscoder::formatForFile(currentTab()->fileName()) != JsonTranscoder::Json)
+	{
+		ui->statusBar->showMessage("Only JSON text files can be canonicalized.", 3000);
+		return;
+	}
+
+	QFileInfo info(currentTab()->fileName());
+	QString destination = QFileDialog::getSaveFileName(this, "Save canonical copy as...", info.dir().filePath(info.completeBaseName() + ".canonical.json"));
+	if (destination.isEmpty())
+	{
+		return;
+	}
+	if (QFileInfo(destination).absoluteFilePath() == info.absoluteFilePath())
+	{
+		ui->statusBar->showMessage("A canonical copy can't replace the file it is made from.", 3000);
+		return;
+	}
+
+	QProgressDialog *progress = new QProgressDialog(QString("Writing %1...").arg(QFileInfo(destination).fileName()), "Cancel", 0, 100, this);
+	progress->setWindowModality(Qt::WindowModal);
+	progress->setMinimumDuration(500);
+
+	JsonCanonicalizer *canonicalizer = new JsonCanonicalizer(info.absoluteFilePath(), destination, this);
+	connect(canonicalizer, &JsonCanonicalizer::progressChanged, progress, &QProgressDialog::setValue);
+	connect(progress, &QProgressDialog::canceled, canonicalizer, &JsonCanonicalizer::cancel);
+	connect(canonicalizer, &QThread::finished, this, [this, canonicalizer, progress, destination]()
+	{
+		progress->deleteLater();
+		if (canonicalizer->succeeded())
+		{
+			ui->statusBar->showMessage(QString("Saved canonical copy to %1").arg(destination), 3000);
+		}
+		else if (!canonicalizer->wasCancelled())
+		{
+			QMessageBox::warning(this, "Could not save a canonical copy", canonicalizer->errorString());
+		}
+		canonicalizer->deleteLater();
+	});
+	canonicalizer->start();
+}
+
+void MainWindow::on_actionFollow_File_toggled(bool follow)
+{
+	JsonDocumentTab *tab = currentTab();
+	if (follow == tab->isFollowing())
+	{
+		return;
+	}
+	if (follow && (tab->fileName().isEmpty() || tab->hasUnsavedChanges()))
+	{
+		// Only an unmodified document that exists on disk can follow its file.
+		ui->statusBar->showMessage("Save the document before following it.", 3000);
+		ui->actionFollow_File->setChecked(false);
+		return;
+	}
+	if (follow && JsonTranscoder::formatForFile(tab->fileName()) != JsonTranscoder::Json)
+	{
+		ui->statusBar->showMessage("Only JSON text files can be followed.", 3000);
+		ui->actionFollow_File->setChecked(false);
+		return;
+	}
+
+	tab->setFollowing(follow);
+}
+
+void MainWindow::on_actionMemory_Usage_triggered()
+{
+	QStringList names;
+	QStringList modes;
+	QVector<JsonMemoryUsage> usages;
+	for (int i = 0; i < ui->documentTabs->count(); i++)
+	{
+		JsonDocumentTab *tab = qobject_cast<JsonDocumentTab *>(ui->documentTabs->widget(i));
+		names.append(tab->title());
+		modes.append(documentMode(tab->editor()));
+		usages.append(tab->editor()->memoryUsage());
+	}
+
+	MemoryUsageDialog dialog(this);
+	dialog.setUsages(names, modes, usages);
+	dialog.exec();
+}
+
+int MainWindow::printMemoryReport(const QStringList &fileNames)
+{
+	QStringList names;
+	QStringList modes;
+	QVector<JsonMemoryUsage> usages;
+	QTextStream errors(stderr);
+	JsonFormatStyle style = JsonFormatStyle::load();
+	foreach (const QString &fileName, fileNames)
+	{
+		if (JsonTranscoder::formatForFile(fileName) != JsonTranscoder::Json)
+		{
+			errors << fileName << ": only JSON text files are reported\n";
+			continue;
+		}
+
+		JsonDocumentTab::Contents contents;
+		contents.fileName = fileName;
+		contents.size = 0;
+		contents.loaded = false;
+		JsonDocumentTab::load(contents);
+		if (!contents.loaded)
+		{
+			errors << fileName << ": could not be read\n";
+			continue;
+		}
+
+		// Each file is measured as it is opened, then once more after formatting it.
+		JsonEditor fileEditor;
+		fileEditor.setFormatStyle(style);
+		fileEditor.setIndexedText(contents.index);
+		contents.index.clear();
+
+		QString name = QFileInfo(fileName).fileName();
+		names << name;
+		modes << documentMode(&fileEditor);
+		usages << fileEditor.memoryUsage();
+
+		fileEditor.setFormatted(true);
+		names << name;
+		modes << documentMode(&fileEditor);
+		usages << fileEditor.memoryUsage();
+	}
+
+	if (usages.isEmpty())
+	{
+		return 1;
+	}
+	QTextStream(stdout) << JsonMemoryUsage::report(names, modes, usages);
+	return 0;
+}
+
+void MainWindow::updatePathLabel(int position)
+{
+	_pathLabel->setText(editor()->structureIndex().pathAt(position));
+}
+
+void MainWindow::createDeferredWidgets()
+{
+	createOutlineDock();
+	createQueryDock();
+}
+
+void MainWindow::createOutlineDock()
+{
+	QDockWidget *outlineDock = new QDockWidget("Outline", this);
+	outlineDock->setObjectName("outlineDock");
+
+	_outlineModel = new JsonOutlineModel(this);
+	_outlineView = new QTreeView(outlineDock);
+	_outlineView->setModel(_outlineModel);
+	_outlineView->setUniformRowHeights(true);
+	_outlineView->header()->setStretchLastSection(true);
+	outlineDock->setWidget(_outlineView);
+
+	addDockWidget(Qt::LeftDockWidgetArea, outlineDock);
+	outlineDock->hide();
+	ui->menuView->addAction(outlineDock->toggleViewAction());
+
+	connect(_outlineView->selectionModel(), &QItemSelectionModel::currentChanged, this, &MainWindow::outlineCurrentChanged);
+	connect(outlineDock, &QDockWidget::visibilityChanged, this, &MainWindow::outlineIndexChanged);
+}
+
+void MainWindow::outlineIndexChanged()
+{
+	if (_outlineView == NULL || !_outlineView->isVisible() || currentTab() == NULL)
+	{
+		// Nothing is built until the outline is actually shown.
+		if (_outlineModel != NULL)
+		{
+			_outlineModel->setStructureIndex(NULL);
+		}
+		return;
+	}
+
+	_outlineModel->setStructureIndex(&editor()->structureIndex());
+	outlineFollowCursor(editor()->rawCursorPosition());
+}
+
+void MainWindow::outlineCurrentChanged(const QModelIndex &current)
+{
+	if (_synchronizingOutline || !current.isValid())
+	{
+		return;
+	}
+
+	_synchronizingOutline = true;
+	editor()->setRawCursorPosition(_outlineModel->offset(current));
+	_synchronizingOutline = false;
+}
+
+void MainWindow::outlineFollowCursor(int position)
+{
+	if (_synchronizingOutline || _outlineView == NULL || !_outlineView->isVisible())
+	{
+		return;
+	}
+
+	QModelIndex index = _outlineModel->indexForOffset(position);
+	if (index.isValid())
+	{
+		_synchronizingOutline = true;
+		_outlineView->setCurrentIndex(index);
+		_outlineView->scrollTo(index);
+		_synchronizingOutline = false;
+	}
+}
+
+void MainWindow::createQueryDock()
+{
+	QDockWidget *queryDock = new QDockWidget("Query", this);
+	queryDock->setObjectName("queryDock");
+
+	QWidget *queryWidget = new QWidget(queryDock);
+	_queryEdit = new QLineEdit(queryWidget);
+	_queryEdit->setPlaceholderText("JSONPath, e.g. $.items[?(@.price < 10)].name");
+	_queryEdit->setClearButtonEnabled(true);
+	_queryResults = new QListWidget(queryWidget);
+	_queryResults->setUniformItemSizes(true);
+
+	QVBoxLayout *layout = new QVBoxLayout(queryWidget);
+	layout->setMargin(0);
+	layout->addWidget(_queryEdit);
+	layout->addWidget(_queryResults);
+	queryDock->setWidget(queryWidget);
+
+	addDockWidget(Qt::BottomDockWidgetArea, queryDock);
+	queryDock->hide();
+	ui->menuView->addAction(queryDock->toggleViewAction());
+
+	connect(_queryEdit, &QLineEdit::returnPressed, this, &MainWindow::runQuery);
+	connect(_queryResults, &QListWidget::currentRowChanged, this, &MainWindow::queryResultSelected);
+	connect(queryDock, &QDockWidget::visibilityChanged, this, [this](bool visible)
+	{
+		if (visible)
+		{
+			_queryEdit->setFocus();
+		}
+	});
+}
+
+void MainWindow::runQuery()
+{
+	JsonQuery query;
+	if (!query.compile(_queryEdit->text()))
+	{
+		ui->statusBar->showMessage(query.errorString(), 5000);
+		return;
+	}
+
+	const JsonStructureIndex &index = editor()->structureIndex();
+	QVector<JsonQuery::Match> matches = query.evaluate(index);
+
+	clearQueryResults();
+	int listed = qMin(matches.count(), MAXIMUM_LISTED_RESULTS);
+	_queryOffsets.reserve(listed);
+	_queryResults->setUpdatesEnabled(false);
+	for (int i = 0; i < listed; i++)
+	{
+		const JsonQuery::Match &match = matches.at(i);
+
+		// Show the start of the value on one line, without any fold markers.
+		QString preview = index.text().mid(match.valueStart, qMin(match.valueEnd - match.valueStart + 1, RESULT_PREVIEW_LENGTH));
+		preview.remove(QChar(HIDDEN_CHAR));
+		preview = preview.simplified();
+		if (match.valueEnd - match.valueStart + 1 > RESULT_PREVIEW_LENGTH)
+		{
+			preview += ELLIPSES;
+		}
+
+		_queryResults->addItem(QString("%1 = %2").arg(index.pathAt(match.offset), preview));
+		_queryOffsets.append(match.offset);
+	}
+	_queryResults->setUpdatesEnabled(true);
+
+	if (matches.count() > listed)
+	{
+		ui->statusBar->showMessage(QString("%1 matches, showing the first %2").arg(matches.count()).arg(listed), 5000);
+	}
+	else
+	{
+		ui->statusBar->showMessage(QString("%1 matches").arg(matches.count()), 5000);
+	}
+}
+
+void MainWindow::queryResultSelected(int row)
+{
+	if (row < 0 || row >= _queryOffsets.count())
+	{
+		return;
+	}
+	editor()->setRawCursorPosition(_queryOffsets.at(row));
+}
+
+void MainWindow::clearQueryResults()
+{
+	// The offsets only hold for the text the query was run on.
+	_queryOffsets.clear();
+	if (_queryResults != NULL)
+	{
+		_queryResults->clear();
+	}
 }
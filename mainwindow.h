@@ -9,12 +9,24 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include <QFile>
+#include <QList>
+#include <QVector>
+#include <QModelIndex>
+#include "jsondocumenttab.h"
 
 namespace Ui {
 class MainWindow;
 }
 
+class QTreeView;
+class QLabel;
+class QLineEdit;
+class QListWidget;
+class JsonOutlineModel;
+class JsonEditor;
+class JsonTranscoder;
+class JsonFileLoader;
+
 class MainWindow : public QMainWindow
 {
 	Q_OBJECT
@@ -23,6 +35,10 @@ public:
 	explicit MainWindow(QWidget *parent = nullptr);
 	~MainWindow();
 
+	void openFiles(JsonFileLoader *loader);
+
+	static int printMemoryReport(const QStringList &fileNames);
+
 public slots:
 	void newDocument();
 	bool openDocument();
@@ -34,7 +50,8 @@ protected:
 	virtual void closeEvent(QCloseEvent *event);
 
 private slots:
-	void documentChanged();
+	void currentTabChanged();
+	void closeTab(int index);
 	void updateWindowTitle();
 
 	void on_actionPreferences_triggered();
@@ -43,11 +60,64 @@ private slots:
 
 	void on_actionCompress_JSON_triggered();
 
+	void on_actionGo_to_Path_triggered();
+
+	void on_actionFold_to_Depth_triggered();
+
+	void on_actionCompare_With_triggered();
+
+	void on_actionSave_Canonical_Copy_triggered();
+
+	void on_actionFollow_File_toggled(bool follow);
+
+	void on_actionMemory_Usage_triggered();
+
+	void updatePathLabel(int position);
+
+	void outlineIndexChanged();
+	void outlineCurrentChanged(const QModelIndex &current);
+	void outlineFollowCursor(int position);
+
+	void runQuery();
+	void queryResultSelected(int row);
+	void clearQueryResults();
+
+	void recoverSession();
+	void enforceMemoryBudget();
+
+	void showLoadedFiles();
+	void createDeferredWidgets();
+
 private:
+	JsonDocumentTab *addDocumentTab();
+	JsonDocumentTab *documentTabForOpening();
+	JsonDocumentTab *currentTab() const;
+	JsonEditor *editor() const;
+	bool closeDocumentTab(JsonDocumentTab *tab);
+	bool confirmClose(JsonDocumentTab *tab);
 	bool saveDocument();
+	bool runTranscoder(JsonTranscoder &transcoder, const QString &label);
+	bool openTranscodedFile(const QString &fileName);
+	bool showContents(QVector<JsonDocumentTab::Contents> &contents);
+	void createOutlineDock();
+	void createQueryDock();
+
 	Ui::MainWindow *ui;
-	QFile _currentDocument;
-	bool _unsavedChanges;
+
+	/// Open documents, most recently shown first.
+	QList<JsonDocumentTab *> _recentTabs;
+
+	JsonOutlineModel *_outlineModel;
+	QTreeView *_outlineView;
+	bool _synchronizingOutline;
+
+	QLineEdit *_queryEdit;
+	QListWidget *_queryResults;
+	QVector<int> _queryOffsets;		///< Where each listed result is, in the document being shown.
+
+	QLabel *_pathLabel;
+
+	JsonFileLoader *_fileLoader;		///< Files from the command line, until they have been read.
 };
 
 #endif // MAINWINDOW_H
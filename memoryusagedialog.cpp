@@ -0,0 +1,96 @@
+/**
+ * @file memoryusagedialog.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "memoryusagedialog.h"
+#include <QTableWidget>
+#include <QHeaderView>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QDialogButtonBox>
+#include <QPushButton>
+#include <QApplication>
+#include <QClipboard>
+
+MemoryUsageDialog::MemoryUsageDialog(QWidget *parent) :
+	QDialog(parent)
+{
+	setWindowTitle("Memory Usage - JSONPad");
+	resize(900, 400);
+
+	_table = new QTableWidget(this);
+	_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+	_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+	_table->verticalHeader()->hide();
+
+	_residentLabel = new QLabel(this);
+
+	QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+	QPushButton *copyButton = buttons->addButton("Copy Report", QDialogButtonBox::ActionRole);
+
+	QVBoxLayout *layout = new QVBoxLayout(this);
+	layout->addWidget(_table);
+	layout->addWidget(_residentLabel);
+	layout->addWidget(buttons);
+
+	connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+	connect(copyButton, &QPushButton::clicked, this, &MemoryUsageDialog::copyReport);
+}
+
+MemoryUsageDialog::~MemoryUsageDialog()
+{
+}
+
+void MemoryUsageDialog::setUsages(const QStringList &names, const QStringList &modes, const QVector<JsonMemoryUsage> &usages)
+{
+	QStringList header;
+	header << "Document" << "Mode";
+	for (int i = 0; i < JsonMemoryUsage::CategoryCount; i++)
+	{
+		header << JsonMemoryUsage::categoryName(JsonMemoryUsage::Category(i));
+	}
+	header << "Total";
+
+	_table->clear();
+	_table->setColumnCount(header.count());
+	_table->setHorizontalHeaderLabels(header);
+	_table->setRowCount(usages.count() + 1);
+
+	// One row per document, then the sum of them all.
+	JsonMemoryUsage sum;
+	for (int row = 0; row <= usages.count(); row++)
+	{
+		bool totalRow = row == usages.count();
+		const JsonMemoryUsage &usage = totalRow ? sum : usages.at(row);
+
+		_table->setItem(row, 0, new QTableWidgetItem(totalRow ? "All documents" : names.at(row)));
+		_table->setItem(row, 1, new QTableWidgetItem(totalRow ? QString() : modes.at(row)));
+		for (int i = 0; i <= JsonMemoryUsage::CategoryCount; i++)
+		{
+			qint64 bytes = i < JsonMemoryUsage::CategoryCount ? usage.bytes(JsonMemoryUsage::Category(i)) : usage.total();
+			QTableWidgetItem *item = new QTableWidgetItem(JsonMemoryUsage::formatBytes(bytes));
+			item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+			_table->setItem(row, i + 2, item);
+		}
+
+		if (!totalRow)
+		{
+			sum += usage;
+		}
+	}
+	_table->resizeColumnsToContents();
+
+	qint64 resident = JsonMemoryUsage::processResidentSize();
+	_residentLabel->setText(resident > 0 ? QString("Process resident size: %1").arg(JsonMemoryUsage::formatBytes(resident)) : QString());
+	_residentLabel->setVisible(resident > 0);
+
+	_report = JsonMemoryUsage::report(names, modes, usages);
+}
+
+void MemoryUsageDialog::copyReport()
+{
+	QApplication::clipboard()->setText(_report);
+}
@@ -0,0 +1,36 @@
+/**
+ * @file memoryusagedialog.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Table of the memory held by each open document.
+ */
+#ifndef MEMORYUSAGEDIALOG_H
+#define MEMORYUSAGEDIALOG_H
+
+#include <QDialog>
+#include "jsonmemoryusage.h"
+
+class QTableWidget;
+class QLabel;
+
+class MemoryUsageDialog : public QDialog
+{
+	Q_OBJECT
+
+public:
+	explicit MemoryUsageDialog(QWidget *parent = nullptr);
+	virtual ~MemoryUsageDialog();
+
+	void setUsages(const QStringList &names, const QStringList &modes, const QVector<JsonMemoryUsage> &usages);
+
+private slots:
+	void copyReport();
+
+private:
+	QTableWidget *_table;
+	QLabel *_residentLabel;
+	QString _report;
+};
+
+#endif // MEMORYUSAGEDIALOG_H
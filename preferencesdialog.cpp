@@ -0,0 +1,118 @@
+/**
+ * @file preferencesdialog.cpp
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief
+ */
+#include "preferencesdialog.h"
+#include <QComboBox>
+#include <QSpinBox>
+#include <QCheckBox>
+#include <QFormLayout>
+#include <QDialogButtonBox>
+
+#define BYTES_PER_MEGABYTE		(1024 * 1024)
+
+PreferencesDialog::PreferencesDialog(QWidget *parent) :
+	QDialog(parent)
+{
+	setWindowTitle("Preferences - JSONPad");
+
+	_indentCombo = new QComboBox(this);
+	_indentCombo->addItem("Tabs");
+	_indentCombo->addItem("Spaces");
+
+	_indentWidthSpin = new QSpinBox(this);
+	_indentWidthSpin->setRange(1, 16);
+
+	_arrayCombo = new QComboBox(this);
+	_arrayCombo->addItem("Inline", JsonFormatStyle::InlineArrays);
+	_arrayCombo->addItem("Expanded", JsonFormatStyle::ExpandedArrays);
+	_arrayCombo->addItem("Inline up to width", JsonFormatStyle::InlineArraysUpToWidth);
+
+	_inlineArrayWidthSpin = new QSpinBox(this);
+	_inlineArrayWidthSpin->setRange(1, 1000);
+
+	_compactObjectWidthSpin = new QSpinBox(this);
+	_compactObjectWidthSpin->setRange(0, 1000);
+	_compactObjectWidthSpin->setSpecialValueText("Never");
+
+	_sortKeysCheck = new QCheckBox("Sort object keys", this);
+
+	_maxStringLengthSpin = new QSpinBox(this);
+	_maxStringLengthSpin->setRange(0, 1000000);
+	_maxStringLengthSpin->setSingleStep(100);
+	_maxStringLengthSpin->setSpecialValueText("Never");
+	_maxStringLengthSpin->setToolTip("Longer strings are cut short in the formatted view; double-click one to show all of it.");
+
+	_memoryCapSpin = new QSpinBox(this);
+	_memoryCapSpin->setRange(0, 1024 * 1024);
+	_memoryCapSpin->setSingleStep(64);
+	_memoryCapSpin->setSuffix(" MB");
+	_memoryCapSpin->setSpecialValueText("None");
+	_memoryCapSpin->setToolTip("A larger document stops keeping undo history, and then shows its raw text instead of the formatted view.");
+
+	QDialogButtonBox *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, this);
+
+	QFormLayout *layout = new QFormLayout(this);
+	layout->addRow("Indent with:", _indentCombo);
+	layout->addRow("Indent width:", _indentWidthSpin);
+	layout->addRow("Arrays:", _arrayCombo);
+	layout->addRow("Inline array width:", _inlineArrayWidthSpin);
+	layout->addRow("Compact objects up to width:", _compactObjectWidthSpin);
+	layout->addRow(_sortKeysCheck);
+	layout->addRow("Shorten strings longer than:", _maxStringLengthSpin);
+	layout->addRow("Memory per document:", _memoryCapSpin);
+	layout->addRow(buttons);
+
+	connect(buttons, &QDialogButtonBox::accepted, this, &QDialog::accept);
+	connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
+	connect(_arrayCombo, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, &PreferencesDialog::updateEnabled);
+
+	setFormatStyle(JsonFormatStyle());
+}
+
+PreferencesDialog::~PreferencesDialog()
+{
+}
+
+JsonFormatStyle PreferencesDialog::formatStyle() const
+{
+	JsonFormatStyle style;
+	style.indentWithTabs = _indentCombo->currentIndex() == 0;
+	style.indentWidth = _indentWidthSpin->value();
+	style.arrayStyle = JsonFormatStyle::ArrayStyle(_arrayCombo->currentData().toInt());
+	style.inlineArrayWidth = _inlineArrayWidthSpin->value();
+	style.compactObjectWidth = _compactObjectWidthSpin->value();
+	style.sortKeys = _sortKeysCheck->isChecked();
+	style.maxStringLength = _maxStringLengthSpin->value();
+	return style;
+}
+
+void PreferencesDialog::setFormatStyle(const JsonFormatStyle &style)
+{
+	_indentCombo->setCurrentIndex(style.indentWithTabs ? 0 : 1);
+	_indentWidthSpin->setValue(style.indentWidth);
+	_arrayCombo->setCurrentIndex(_arrayCombo->findData(style.arrayStyle));
+	_inlineArrayWidthSpin->setValue(style.inlineArrayWidth);
+	_compactObjectWidthSpin->setValue(style.compactObjectWidth);
+	_sortKeysCheck->setChecked(style.sortKeys);
+	_maxStringLengthSpin->setValue(style.maxStringLength);
+	updateEnabled();
+}
+
+qint64 PreferencesDialog::memoryCap() const
+{
+	return qint64(_memoryCapSpin->value()) * BYTES_PER_MEGABYTE;
+}
+
+void PreferencesDialog::setMemoryCap(qint64 bytes)
+{
+	_memoryCapSpin->setValue(int(bytes / BYTES_PER_MEGABYTE));
+}
+
+void PreferencesDialog::updateEnabled()
+{
+	_inlineArrayWidthSpin->setEnabled(_arrayCombo->currentData().toInt() == JsonFormatStyle::InlineArraysUpToWidth);
+}
@@ -0,0 +1,46 @@
+/**
+ * @file preferencesdialog.h
+ *
+ * @date 10/19/2026
+ * @author Anthony Hilyard
+ * @brief Dialog for choosing how documents are formatted and how much memory they may take.
+ */
+#ifndef PREFERENCESDIALOG_H
+#define PREFERENCESDIALOG_H
+
+#include <QDialog>
+#include "jsonformatter.h"
+
+class QComboBox;
+class QSpinBox;
+class QCheckBox;
+
+class PreferencesDialog : public QDialog
+{
+	Q_OBJECT
+
+public:
+	explicit PreferencesDialog(QWidget *parent = nullptr);
+	virtual ~PreferencesDialog();
+
+	JsonFormatStyle formatStyle() const;
+	void setFormatStyle(const JsonFormatStyle &style);
+
+	qint64 memoryCap() const;
+	void setMemoryCap(qint64 bytes);
+
+private slots:
+	void updateEnabled();
+
+private:
+	QComboBox *_indentCombo;
+	QSpinBox *_indentWidthSpin;
+	QComboBox *_arrayCombo;
+	QSpinBox *_inlineArrayWidthSpin;
+	QSpinBox *_compactObjectWidthSpin;
+	QCheckBox *_sortKeysCheck;
+	QSpinBox *_maxStringLengthSpin;
+	QSpinBox *_memoryCapSpin;
+};
+
+#endif // PREFERENCESDIALOG_H